@@ -0,0 +1,250 @@
+// //////////////////////////////////////////////////////////
+// calibrate.cpp
+// Copyright (c) 2020 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+// g++ -O3 -std=c++11 calibrate.cpp -o calibrate
+// ./calibrate [output]
+// measures crossover thresholds on this machine and writes them to [output] (default: sort_tuning.h)
+// then re-compile everything that includes sort.h
+
+#include <cstdio>
+#include <cstdlib>   // srand/rand
+#include <cmath>     // sqrt
+#include <ctime>     // time
+
+#include <vector>
+#include <string>
+
+#include "sort.h"
+
+#ifdef _MSC_VER
+#define USE_WINDOWS_TIMER
+#endif
+
+#ifdef USE_WINDOWS_TIMER
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+
+// OS-specific timing
+static double seconds()
+{
+#ifdef USE_WINDOWS_TIMER
+  LARGE_INTEGER frequency, now;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter  (&now);
+  return now.QuadPart / double(frequency.QuadPart);
+#else
+  timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec/1000000.0;
+#endif
+}
+
+
+// each measurement is repeated and the fastest run is used
+const int Repetitions = 5;
+// total number of elements sorted per measurement (spread across many small arrays if needed)
+const int ElementsPerRun = 1 << 20;
+
+
+/// random test data
+template <typename Value>
+std::vector<Value> randomData(size_t numElements);
+
+template <>
+std::vector<int> randomData<int>(size_t numElements)
+{
+  std::vector<int> result(numElements);
+  for (auto& x : result)
+    x = rand();
+  return result;
+}
+
+template <>
+std::vector<double> randomData<double>(size_t numElements)
+{
+  std::vector<double> result(numElements);
+  for (auto& x : result)
+    x = rand() / double(RAND_MAX);
+  return result;
+}
+
+template <>
+std::vector<std::string> randomData<std::string>(size_t numElements)
+{
+  std::vector<std::string> result(numElements);
+  for (auto& x : result)
+    x = "key/" + std::to_string(rand());
+  return result;
+}
+
+
+/// sort ElementsPerRun elements in chunks of "numElements" elements, return fastest time per element
+template <typename Value, typename Sorter>
+double measure(size_t numElements, Sorter sorter)
+{
+  auto input = randomData<Value>(ElementsPerRun);
+  double best = 1e30;
+  for (int repeat = 0; repeat < Repetitions; repeat++)
+  {
+    auto data = input;
+    double start = seconds();
+    for (size_t offset = 0; offset + numElements <= data.size(); offset += numElements)
+      sorter(data.begin() + offset, data.begin() + offset + numElements);
+    double duration = seconds() - start;
+    if (best > duration)
+      best = duration;
+  }
+  return best / ElementsPerRun;
+}
+
+
+/// Intro Sort's Insertion Sort cutoff, averaged over several sizes for one data type
+template <typename Value>
+void measureIntroSortCutoff(const std::vector<size_t>& cutoffs, std::vector<double>& relativeTime)
+{
+  typedef typename std::vector<Value>::iterator Iterator;
+  const size_t Sizes[] = { 100, 1000, 100000 };
+  for (auto numElements : Sizes)
+  {
+    std::vector<double> times;
+    for (auto cutoff : cutoffs)
+      times.push_back(measure<Value>(numElements, [cutoff](Iterator first, Iterator last)
+                                     { introSort(first, last, std::less<Value>(), cutoff); }));
+
+    // normalize, each size and data type contributes equally
+    double fastest = *std::min_element(times.begin(), times.end());
+    for (size_t i = 0; i < cutoffs.size(); i++)
+      relativeTime[i] += times[i] / fastest;
+  }
+}
+
+
+/// time of an n-ary Heap Sort
+template <size_t Width>
+double measureHeapWidth()
+{
+  typedef std::vector<int>::iterator Iterator;
+  return measure<int>(ElementsPerRun, [](Iterator first, Iterator last) { naryHeapSort<Width>(first, last); });
+}
+
+
+int main(int argc, char** argv)
+{
+  const char* filename = argc >= 2 ? argv[1] : "sort_tuning.h";
+  srand(time(NULL));
+
+  // Intro Sort's Insertion Sort cutoff
+  std::vector<size_t> cutoffs = { 4, 8, 12, 16, 20, 24, 32, 48, 64 };
+  std::vector<double> relativeTime(cutoffs.size(), 0);
+  measureIntroSortCutoff<int>        (cutoffs, relativeTime);
+  measureIntroSortCutoff<double>     (cutoffs, relativeTime);
+  measureIntroSortCutoff<std::string>(cutoffs, relativeTime);
+  size_t bestCutoff = 0;
+  for (size_t i = 0; i < cutoffs.size(); i++)
+  {
+    printf("Intro Sort cutoff %2d\t%.3f\n", int(cutoffs[i]), relativeTime[i]);
+    if (relativeTime[i] < relativeTime[bestCutoff])
+      bestCutoff = i;
+  }
+  size_t introSortCutoff = cutoffs[bestCutoff];
+
+  // width of n-ary Heap Sort
+  const size_t Widths[] = { 2, 3, 4, 6, 8, 12, 16 };
+  double heapTimes[] = { measureHeapWidth<2>(), measureHeapWidth<3>(),  measureHeapWidth<4>(), measureHeapWidth<6>(),
+                         measureHeapWidth<8>(), measureHeapWidth<12>(), measureHeapWidth<16>() };
+  size_t bestWidth = 0;
+  for (size_t i = 0; i < sizeof(Widths) / sizeof(Widths[0]); i++)
+  {
+    printf("n-ary Heap Sort width %2d\t%.3f ns/element\n", int(Widths[i]), 1e9 * heapTimes[i]);
+    if (heapTimes[i] < heapTimes[bestWidth])
+      bestWidth = i;
+  }
+  size_t heapWidth = Widths[bestWidth];
+
+  // largest input for O(n^2) algorithms that finishes in about one second (Bubble Sort is the slowest)
+  const size_t QuadraticProbe = 4000;
+  auto probe = randomData<int>(QuadraticProbe);
+  double quadraticTime = seconds();
+  bubbleSort(probe.begin(), probe.end());
+  quadraticTime = seconds() - quadraticTime;
+  int restrictedSort = int(QuadraticProbe * sqrt(1.0 / quadraticTime));
+  // round to a multiple of 1000
+  restrictedSort = restrictedSort < 1000 ? 1000 : (restrictedSort / 1000) * 1000;
+  printf("RestrictedSort\t%d\n", restrictedSort);
+
+  // smallest input where Radix Sort beats Intro Sort
+  typedef std::vector<int>::iterator Iterator;
+  size_t minRadixSize = 0;
+  for (size_t numElements = 64; numElements <= ElementsPerRun; numElements *= 2)
+  {
+    double radix = measure<int>(numElements, [](Iterator first, Iterator last) { radixSort(first, last); });
+    double intro = measure<int>(numElements, [](Iterator first, Iterator last) { introSort(first, last); });
+    printf("Radix Sort vs Intro Sort %7d\t%.3f vs %.3f ns/element\n", int(numElements), 1e9 * radix, 1e9 * intro);
+    if (radix < intro)
+    {
+      minRadixSize = numElements;
+      break;
+    }
+  }
+  // never faster ? => effectively disable
+  if (minRadixSize == 0)
+    minRadixSize = ~size_t(0) >> 1;
+
+  // tile size of tiled Merge Sort, sweep from L1 to L3 cache sizes
+  size_t tileBytes = 0;
+  double bestTiled = 1e30;
+  for (size_t bytes = 32 * 1024; bytes <= 4 * 1024 * 1024; bytes *= 2)
+  {
+    double tiled = measure<int>(ElementsPerRun, [bytes](Iterator first, Iterator last)
+                                { mergeSortTiled(first, last, std::less<int>(), bytes); });
+    printf("tiled Merge Sort %4d KiB\t%.3f ns/element\n", int(bytes / 1024), 1e9 * tiled);
+    if (tiled < bestTiled)
+    {
+      bestTiled = tiled;
+      tileBytes = bytes;
+    }
+  }
+
+  // write header
+  FILE* output = fopen(filename, "w");
+  if (!output)
+  {
+    printf("cannot write %s\n", filename);
+    return 1;
+  }
+  fprintf(output,
+    "// //////////////////////////////////////////////////////////\n"
+    "// sort_tuning.h\n"
+    "// generated by calibrate.cpp\n"
+    "// see http://create.stephan-brumme.com/disclaimer.html\n"
+    "//\n"
+    "\n"
+    "// re-generate on the target machine:\n"
+    "// g++ -O3 -std=c++11 calibrate.cpp -o calibrate && ./calibrate sort_tuning.h\n"
+    "\n"
+    "#pragma once\n"
+    "\n"
+    "#include <cstddef> // size_t\n"
+    "\n"
+    "/// Intro Sort switches to Insertion Sort for ranges up to this size\n"
+    "constexpr size_t SortTuningIntroSortCutoff = %d;\n"
+    "/// width of n-ary Heap Sort in the benchmark\n"
+    "constexpr size_t SortTuningNaryHeapWidth   = %d;\n"
+    "/// benchmark skips O(n^2) algorithms beyond this number of elements\n"
+    "constexpr int    SortTuningRestrictedSort  = %d;\n"
+    "/// Auto Sort prefers Radix Sort for integers when there are at least this many elements\n"
+    "constexpr size_t SortTuningMinRadixSize    = %llu;\n"
+    "/// tiled Merge Sort sorts tiles of this size (in bytes) in the cache before merging them\n"
+    "constexpr size_t SortTuningTileBytes       = %llu;\n",
+    int(introSortCutoff), int(heapWidth), restrictedSort, (unsigned long long)minRadixSize, (unsigned long long)tileBytes);
+  fclose(output);
+
+  printf("wrote %s\n", filename);
+  return 0;
+}
@@ -20,11 +20,12 @@ typedef int Value;
 // - random access iterator
 
 // uncomment at most one line to switch between those three iterators
+// (or add -DFORWARDITERATOR / -DBIDIRECTIONALITERATOR to GCC's command-line)
 //#define BIDIRECTIONALITERATOR
-#define RANDOMACCESSITERATOR
-// fallback if neither BIDIRECTIONALITERATOR nor RANDOMACCESSITERATOR is defined
-#if !defined(BIDIRECTIONALITERATOR) && !defined(RANDOMACCESSITERATOR)
-  #define FORWARDITERATOR
+//#define FORWARDITERATOR
+// random access iterator if neither BIDIRECTIONALITERATOR nor FORWARDITERATOR is defined
+#if !defined(BIDIRECTIONALITERATOR) && !defined(FORWARDITERATOR)
+  #define RANDOMACCESSITERATOR
 #endif
 
 // forward declaration
@@ -34,7 +35,7 @@ class Container;
 class Iterator :
 #if !defined(BIDIRECTIONALITERATOR) && !defined(RANDOMACCESSITERATOR)
                  public std::iterator<std::forward_iterator_tag,       int>
-#elseif defined(BIDIRECTIONALITERATOR) && !defined(RANDOMACCESSITERATOR)
+#elif defined(BIDIRECTIONALITERATOR) && !defined(RANDOMACCESSITERATOR)
                  public std::iterator<std::bidirectional_iterator_tag, int>
 #else
                  public std::iterator<std::random_access_iterator_tag, int>
@@ -60,7 +61,7 @@ public:
   /// step backward (prefix)
   Iterator& operator--()    { --iterator; return *this; }
   /// step backward (postfix)
-  Iterator  operator--(int) { Iterator result(*this); ++iterator; return result; }
+  Iterator  operator--(int) { Iterator result(*this); --iterator; return result; }
 #endif
 
 #if defined(RANDOMACCESSITERATOR)
@@ -9,13 +9,40 @@
 // if [size] is omitted then 100 integers are sorted
 
 #include <cstdio>
+#include <cstdlib>   // malloc/free
+#include <cmath>     // log2, lgamma
 
+#include <new>
 #include <vector>
+#include <string>
 #include <algorithm> // std::sort, std::reverse
+#if __cplusplus >= 201703L
+#include <memory_resource> // std::pmr::monotonic_buffer_resource
+#endif
 
 #include "sort.h"
 
 
+/// count heap allocations (replaces global operator new)
+static int numAllocations = 0;
+void* operator new(size_t size)
+{
+  ++numAllocations;
+  void* memory = malloc(size ? size : 1);
+  if (!memory)
+    throw std::bad_alloc();
+  return memory;
+}
+void operator delete(void* memory) noexcept
+{
+  free(memory);
+}
+void operator delete(void* memory, size_t) noexcept
+{
+  free(memory);
+}
+
+
 /// count assignments and comparisions
 class Number
 {
@@ -36,7 +63,7 @@ public:
   bool operator==(const Number& other) const { return                value == other.value; }
 
   /// reset counters
-  static void reset() { numLessThan = numAssignments = 0; }
+  static void reset() { numLessThan = numAssignments = numAllocations = 0; }
 
 private:
   /// actually just a simple integer
@@ -55,6 +82,36 @@ typedef std::vector<Number> Container;
 const int MaxSort = 100000;
 
 
+// protect server from overload: O(n^2) moves
+const int MaxMergeInsertion = 10000;
+
+// sorting networks only for tiny inputs (larger inputs are handled by Intro Sort)
+const int MaxSmallSort = 64;
+
+/// comparisons are shown relative to n*log2(n), too
+static double nLog2n = 1;
+
+/// show comparisons, assignments and heap allocations
+static void printCounters()
+{
+  printf("\t%d (%.3f)\t%d\t%d", Number::numLessThan, Number::numLessThan / nLog2n, Number::numAssignments, numAllocations);
+}
+
+/// algorithms called with NoAlloc() must not allocate any heap memory
+static bool allocationFailed = false;
+
+/// show counters, flag heap allocations
+static void printCountersNoAlloc()
+{
+  printCounters();
+  if (numAllocations > 0)
+  {
+    printf(" ALLOCATED");
+    allocationFailed = true;
+  }
+}
+
+
 int main(int argc, char** argv)
 {
   // number of elements to be sorted
@@ -73,6 +130,12 @@ int main(int argc, char** argv)
 
   printf("%d element%s", numElements, numElements == 1 ? "":"s");
 
+  // information-theoretic lower bound: log2(n!) comparisons
+  if (numElements >= 2)
+    nLog2n = numElements * log2(double(numElements));
+  double minComparisons = lgamma(numElements + 1.0) / log(2.0);
+  printf("\tlog2(n!) = %.0f comparisons (%.3f * n*log2(n))", minComparisons, minComparisons / nLog2n);
+
   // initialize containers
   // 0,1,2,3,4,...
   Container ascending(numElements);
@@ -96,205 +159,877 @@ int main(int argc, char** argv)
   data = ascending;
   Number::reset();
   bubbleSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   bubbleSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   bubbleSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   // selection sort
   printf("\nSelection Sort");
   data = ascending;
   Number::reset();
   selectionSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   selectionSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   selectionSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   // insertion sort
   printf("\nInsertion Sort");
   data = ascending;
   Number::reset();
   insertionSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   insertionSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   insertionSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
+
+  // binary insertion sort
+  printf("\nBinary Insertion Sort");
+  data = ascending;
+  Number::reset();
+  binaryInsertionSort(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  binaryInsertionSort(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  binaryInsertionSort(data.begin(), data.end());
+  printCounters();
 
   // shell sort
   printf("\nShell Sort");
   data = ascending;
   Number::reset();
   shellSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   shellSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   shellSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   // heap sort
   printf("\nHeap Sort");
   data = ascending;
   Number::reset();
   heapSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   heapSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   heapSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
+
+  // n-ary heap sort
+  printf("\n2-ary Heap Sort");
+  data = ascending;
+  Number::reset();
+  naryHeapSort<2>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  naryHeapSort<2>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  naryHeapSort<2>(data.begin(), data.end());
+  printCounters();
+
+  // n-ary heap sort
+  printf("\n4-ary Heap Sort");
+  data = ascending;
+  Number::reset();
+  naryHeapSort<4>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  naryHeapSort<4>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  naryHeapSort<4>(data.begin(), data.end());
+  printCounters();
 
   // n-ary heap sort
   printf("\n8-ary Heap Sort");
   data = ascending;
   Number::reset();
   naryHeapSort<8>(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   naryHeapSort<8>(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   naryHeapSort<8>(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
+
+  // n-ary heap sort
+  printf("\n16-ary Heap Sort");
+  data = ascending;
+  Number::reset();
+  naryHeapSort<16>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  naryHeapSort<16>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  naryHeapSort<16>(data.begin(), data.end());
+  printCounters();
 
   // merge sort
   printf("\nMerge Sort");
   data = ascending;
   Number::reset();
   mergeSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   mergeSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   mergeSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
+
+  // bottom-up merge sort
+  printf("\nMerge Sort (bottom-up)");
+  data = ascending;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end());
+  printCounters();
+
+  // tiled merge sort
+  printf("\nMerge Sort (tiled)");
+  data = ascending;
+  Number::reset();
+  mergeSortTiled(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  mergeSortTiled(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  mergeSortTiled(data.begin(), data.end());
+  printCounters();
+
+  // merge sort without heap allocations
+  printf("\nMerge Sort (no alloc)");
+  data = ascending;
+  Number::reset();
+  mergeSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  mergeSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  mergeSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  // bottom-up merge sort without heap allocations
+  printf("\nMerge Sort (bottom-up, no alloc)");
+  data = ascending;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  // tiled merge sort without heap allocations
+  printf("\nMerge Sort (tiled, no alloc)");
+  data = ascending;
+  Number::reset();
+  mergeSortTiled(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  mergeSortTiled(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  mergeSortTiled(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  // merge sort with merge insertion without heap allocations
+  printf("\nMerge Sort (min. comparisons, no alloc)");
+  data = ascending;
+  Number::reset();
+  mergeSortMinComparisons(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  mergeSortMinComparisons(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  mergeSortMinComparisons(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  // stable sort without heap allocations
+  printf("\nstableSort (no alloc)");
+  data = ascending;
+  Number::reset();
+  stableSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  stableSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  stableSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  // auto sort without heap allocations
+  printf("\nAuto Sort (no alloc)");
+  data = ascending;
+  Number::reset();
+  autoSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  autoSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  autoSort(data.begin(), data.end(), std::less<Number>(), NoAlloc());
+  printCountersNoAlloc();
+
+  // caller-provided scratch buffers and memory resources must not allocate any heap memory either
+  // (buffers and containers are created before the counters are reset)
+  Container scratch(numElements);
+  std::vector<int>    ascendingInts(numElements), descendingInts, randomInts, dataInts;
+  std::vector<double> ascendingDoubles(numElements), descendingDoubles, randomDoubles, dataDoubles;
+  std::vector<std::string> ascendingStrings(numElements), descendingStrings, randomStrings, dataStrings;
+  for (int i = 0; i < numElements; i++)
+  {
+    ascendingInts   [i] = i;
+    ascendingDoubles[i] = i;
+    ascendingStrings[i] = std::to_string(1000000 + i); // short strings don't allocate when moved
+  }
+  descendingInts    = std::vector<int>        (ascendingInts   .rbegin(), ascendingInts   .rend());
+  descendingDoubles = std::vector<double>     (ascendingDoubles.rbegin(), ascendingDoubles.rend());
+  descendingStrings = std::vector<std::string>(ascendingStrings.rbegin(), ascendingStrings.rend());
+  randomInts    = ascendingInts;
+  randomDoubles = ascendingDoubles;
+  randomStrings = ascendingStrings;
+  std::random_shuffle(randomInts   .begin(), randomInts   .end());
+  std::random_shuffle(randomDoubles.begin(), randomDoubles.end());
+  std::random_shuffle(randomStrings.begin(), randomStrings.end());
+  dataInts   .reserve(numElements);
+  dataDoubles.reserve(numElements);
+  dataStrings.reserve(numElements);
+
+  // merge sort with a scratch buffer
+  printf("\nMerge Sort (scratch buffer)");
+  data = ascending;
+  Number::reset();
+  mergeSort(data.begin(), data.end(), std::less<Number>(), scratch.data(), scratch.size());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  mergeSort(data.begin(), data.end(), std::less<Number>(), scratch.data(), scratch.size());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  mergeSort(data.begin(), data.end(), std::less<Number>(), scratch.data(), scratch.size());
+  printCountersNoAlloc();
+
+  // bottom-up merge sort with a scratch buffer
+  printf("\nMerge Sort (bottom-up, scratch buffer)");
+  data = ascending;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), scratch.data());
+  printCountersNoAlloc();
+
+  data = descending;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), scratch.data());
+  printCountersNoAlloc();
+
+  data = random;
+  Number::reset();
+  mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), scratch.data());
+  printCountersNoAlloc();
+
+  // radix sort with a scratch buffer
+  printf("\nRadix Sort (scratch buffer)");
+  std::vector<int> scratchInts(numElements);
+  dataInts = ascendingInts;
+  Number::reset();
+  radixSort(dataInts.begin(), dataInts.end(), scratchInts.data());
+  printCountersNoAlloc();
+
+  dataInts = descendingInts;
+  Number::reset();
+  radixSort(dataInts.begin(), dataInts.end(), scratchInts.data());
+  printCountersNoAlloc();
+
+  dataInts = randomInts;
+  Number::reset();
+  radixSort(dataInts.begin(), dataInts.end(), scratchInts.data());
+  printCountersNoAlloc();
+
+  // floats without heap allocations
+  printf("\nfloatSort (no alloc)");
+  dataDoubles = ascendingDoubles;
+  Number::reset();
+  floatSort(dataDoubles.begin(), dataDoubles.end(), NoAlloc());
+  printCountersNoAlloc();
+
+  dataDoubles = descendingDoubles;
+  Number::reset();
+  floatSort(dataDoubles.begin(), dataDoubles.end(), NoAlloc());
+  printCountersNoAlloc();
+
+  dataDoubles = randomDoubles;
+  Number::reset();
+  floatSort(dataDoubles.begin(), dataDoubles.end(), NoAlloc());
+  printCountersNoAlloc();
+
+#if __cplusplus >= 201703L
+  // memory resources which must not fall back to the heap: each call gets a fresh monotonic buffer
+  std::vector<char> arena(numElements * (sizeof(std::string) + 2 * sizeof(size_t) + sizeof(Number)) + 4096);
+
+  // merge sort with a memory resource
+  printf("\nMerge Sort (pmr)");
+  data = ascending;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    mergeSort(data.begin(), data.end(), std::less<Number>(), &resource);
+    printCountersNoAlloc();
+  }
+
+  data = descending;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    mergeSort(data.begin(), data.end(), std::less<Number>(), &resource);
+    printCountersNoAlloc();
+  }
+
+  data = random;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    mergeSort(data.begin(), data.end(), std::less<Number>(), &resource);
+    printCountersNoAlloc();
+  }
+
+  // bottom-up merge sort with a memory resource
+  printf("\nMerge Sort (bottom-up, pmr)");
+  data = ascending;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), &resource);
+    printCountersNoAlloc();
+  }
+
+  data = descending;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), &resource);
+    printCountersNoAlloc();
+  }
+
+  data = random;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    mergeSortBottomUp(data.begin(), data.end(), std::less<Number>(), &resource);
+    printCountersNoAlloc();
+  }
+
+  // radix sort with a memory resource
+  printf("\nRadix Sort (pmr)");
+  dataInts = ascendingInts;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    radixSort(dataInts.begin(), dataInts.end(), &resource);
+    printCountersNoAlloc();
+  }
+
+  dataInts = descendingInts;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    radixSort(dataInts.begin(), dataInts.end(), &resource);
+    printCountersNoAlloc();
+  }
+
+  dataInts = randomInts;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    radixSort(dataInts.begin(), dataInts.end(), &resource);
+    printCountersNoAlloc();
+  }
+
+  // LCP merge sort with a memory resource
+  printf("\nLCP Merge Sort (pmr)");
+  dataStrings = ascendingStrings;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    lcpMergeSort(dataStrings.begin(), dataStrings.end(), &resource);
+    printCountersNoAlloc();
+  }
+
+  dataStrings = descendingStrings;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    lcpMergeSort(dataStrings.begin(), dataStrings.end(), &resource);
+    printCountersNoAlloc();
+  }
+
+  dataStrings = randomStrings;
+  {
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+    Number::reset();
+    lcpMergeSort(dataStrings.begin(), dataStrings.end(), &resource);
+    printCountersNoAlloc();
+  }
+#endif
 
   // in-place merge sort
   printf("\nMerge Sort in-place");
   data = ascending;
   Number::reset();
   mergeSortInPlace(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   mergeSortInPlace(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   mergeSortInPlace(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
+
+  // merge insertion (Ford-Johnson)
+  printf("\nMerge Insertion");
+  if (numElements <= MaxMergeInsertion)
+  {
+    data = ascending;
+    Number::reset();
+    mergeInsertionSort(data.begin(), data.end());
+    printCounters();
+
+    data = descending;
+    Number::reset();
+    mergeInsertionSort(data.begin(), data.end());
+    printCounters();
+
+    data = random;
+    Number::reset();
+    mergeInsertionSort(data.begin(), data.end());
+    printCounters();
+  }
+  else
+    printf("\tn/a\tn/a\tn/a");
+
+  // merge sort with merge insertion for small ranges
+  printf("\nMerge Sort (min. comparisons)");
+  data = ascending;
+  Number::reset();
+  mergeSortMinComparisons(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  mergeSortMinComparisons(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  mergeSortMinComparisons(data.begin(), data.end());
+  printCounters();
 
   // quick sort
   printf("\nQuick Sort");
   data = ascending;
   Number::reset();
   quickSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   quickSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   quickSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
+
+  // quick sort, pivot: middle
+  printf("\nQuick Sort (middle)");
+  data = ascending;
+  Number::reset();
+  quickSort<PivotMiddle>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  quickSort<PivotMiddle>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  quickSort<PivotMiddle>(data.begin(), data.end());
+  printCounters();
+
+  // quick sort, pivot: median-of-3
+  printf("\nQuick Sort (median-of-3)");
+  data = ascending;
+  Number::reset();
+  quickSort<PivotMedianOf3>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  quickSort<PivotMedianOf3>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  quickSort<PivotMedianOf3>(data.begin(), data.end());
+  printCounters();
+
+  // quick sort, pivot: ninther
+  printf("\nQuick Sort (ninther)");
+  data = ascending;
+  Number::reset();
+  quickSort<PivotNinther>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  quickSort<PivotNinther>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  quickSort<PivotNinther>(data.begin(), data.end());
+  printCounters();
+
+  // quick sort, pivot: random sample
+  printf("\nQuick Sort (random sample)");
+  data = ascending;
+  Number::reset();
+  quickSort<PivotRandomSample>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  quickSort<PivotRandomSample>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  quickSort<PivotRandomSample>(data.begin(), data.end());
+  printCounters();
+
+  // iterative quick sort
+  printf("\nQuick Sort (iterative)");
+  data = ascending;
+  Number::reset();
+  quickSortIterative(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  quickSortIterative(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  quickSortIterative(data.begin(), data.end());
+  printCounters();
+
+  // three-way quick sort
+  printf("\nQuick Sort (three-way)");
+  data = ascending;
+  Number::reset();
+  quickSort3Way(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  quickSort3Way(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  quickSort3Way(data.begin(), data.end());
+  printCounters();
 
   // intro sort
   printf("\nIntro Sort");
   data = ascending;
   Number::reset();
   introSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   introSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   introSort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
+
+  // intro sort, pivot: middle
+  printf("\nIntro Sort (middle)");
+  data = ascending;
+  Number::reset();
+  introSort<PivotMiddle>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  introSort<PivotMiddle>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  introSort<PivotMiddle>(data.begin(), data.end());
+  printCounters();
+
+  // intro sort, pivot: median-of-3
+  printf("\nIntro Sort (median-of-3)");
+  data = ascending;
+  Number::reset();
+  introSort<PivotMedianOf3>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  introSort<PivotMedianOf3>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  introSort<PivotMedianOf3>(data.begin(), data.end());
+  printCounters();
+
+  // intro sort, pivot: ninther
+  printf("\nIntro Sort (ninther)");
+  data = ascending;
+  Number::reset();
+  introSort<PivotNinther>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  introSort<PivotNinther>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  introSort<PivotNinther>(data.begin(), data.end());
+  printCounters();
+
+  // intro sort, pivot: random sample
+  printf("\nIntro Sort (random sample)");
+  data = ascending;
+  Number::reset();
+  introSort<PivotRandomSample>(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  introSort<PivotRandomSample>(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  introSort<PivotRandomSample>(data.begin(), data.end());
+  printCounters();
+
+  // small sort (sorting networks)
+  printf("\nSmall Sort");
+  if (numElements <= MaxSmallSort)
+  {
+    data = ascending;
+    Number::reset();
+    smallSort(data.begin(), data.end());
+    printCounters();
+
+    data = descending;
+    Number::reset();
+    smallSort(data.begin(), data.end());
+    printCounters();
+
+    data = random;
+    Number::reset();
+    smallSort(data.begin(), data.end());
+    printCounters();
+  }
+  else
+    printf("\tn/a\tn/a\tn/a");
+
+  // auto sort
+  printf("\nAuto Sort");
+  data = ascending;
+  Number::reset();
+  autoSort(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  autoSort(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  autoSort(data.begin(), data.end());
+  printCounters();
+
+  // stable sort
+  printf("\nstableSort");
+  data = ascending;
+  Number::reset();
+  stableSort(data.begin(), data.end());
+  printCounters();
+
+  data = descending;
+  Number::reset();
+  stableSort(data.begin(), data.end());
+  printCounters();
+
+  data = random;
+  Number::reset();
+  stableSort(data.begin(), data.end());
+  printCounters();
 
   // std::sort
   printf("\nstd::sort");
   data = ascending;
   Number::reset();
   std::sort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   std::sort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   std::sort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   // std::stable_sort
   printf("\nstd::stable_sort");
   data = ascending;
   Number::reset();
   std::stable_sort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = descending;
   Number::reset();
   std::stable_sort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   data = random;
   Number::reset();
   std::stable_sort(data.begin(), data.end());
-  printf("\t%d\t%d", Number::numLessThan, Number::numAssignments);
+  printCounters();
 
   printf("\n");
-  return 0;
+  return allocationFailed ? 1 : 0;
 }
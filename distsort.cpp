@@ -0,0 +1,255 @@
+// //////////////////////////////////////////////////////////
+// distsort.cpp
+// Copyright (c) 2020 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+// g++ -O3 -std=c++11 distsort.cpp -o distsort
+// Linux/POSIX only (fork, sockets)
+//
+// ./distsort [numElements] [maxWorkers] [unix|tcp]                    => sort with 1, 2, ..., maxWorkers local processes
+// ./distsort worker <rank> <host:port,host:port,...> [numElements]    => one worker of a cluster (TCP), start one per host
+//
+// each worker generates numElements / numWorkers random integers, then all workers sort them together,
+// worker 0 collects each worker's size, order, first/last element and fingerprint and validates the result
+
+#include <cstdio>
+#include <cstdlib>   // atoi, strtoull
+#include <cstring>   // strcmp
+
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "distsort.h"
+
+
+// timing
+static double seconds()
+{
+  timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec/1000000.0;
+}
+
+
+/// sent by each worker to worker 0 after sorting
+struct Summary
+{
+  uint64_t numElements;
+  uint64_t fingerprintBefore;
+  uint64_t fingerprintAfter;
+  int      sorted;
+  int      first;
+  int      last;
+  double   duration;
+};
+
+
+/// generate random data, sort it with all other workers and validate the result (worker 0 prints it), return exit code
+static int runWorker(Transport& transport, size_t totalElements)
+{
+  int    rank       = transport.rank();
+  size_t numWorkers = transport.numWorkers();
+
+  // local share of the data, worker 0 gets the remainder
+  size_t numElements = totalElements / numWorkers + (rank == 0 ? totalElements % numWorkers : 0);
+  std::vector<int> data(numElements);
+  uint64_t seed = 12345 + rank;
+  for (auto& x : data)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    x = int(seed >> 33);
+  }
+
+  Summary summary;
+  summary.fingerprintBefore = fingerprint(data.begin(), data.end());
+
+  // sort
+  if (!transport.barrier())
+    return 1;
+  double start = seconds();
+  bool ok = distributedSort(data, transport);
+  ok = ok && transport.barrier();
+  summary.duration = seconds() - start;
+  if (!ok)
+  {
+    printf("worker %d: transport failed\n", rank);
+    return 1;
+  }
+
+  summary.numElements      = data.size();
+  summary.fingerprintAfter = fingerprint(data.begin(), data.end());
+  summary.sorted           = isSorted(data.begin(), data.end());
+  summary.first            = data.empty() ? 0 : data.front();
+  summary.last             = data.empty() ? 0 : data.back();
+
+  // collect all summaries at worker 0
+  std::vector<std::vector<char> > outgoing(numWorkers), incoming;
+  appendBytes(outgoing[0], &summary, 1);
+  if (!transport.allToAll(outgoing, incoming))
+    return 1;
+  if (rank != 0)
+    return 0;
+
+  // validate: each range is sorted, ranges don't overlap, no elements were lost or duplicated
+  std::vector<Summary> summaries;
+  for (auto& bytes : incoming)
+    appendElements(summaries, bytes);
+
+  bool     valid   = true;
+  uint64_t total   = 0;
+  uint64_t before  = 0;
+  uint64_t after   = 0;
+  double   slowest = 0;
+  size_t   largest = 0;
+  bool     hasPrevious = false;
+  int      previous    = 0;
+  for (auto& current : summaries)
+  {
+    valid = valid && current.sorted;
+    if (current.numElements > 0)
+    {
+      valid = valid && (!hasPrevious || previous <= current.first);
+      previous    = current.last;
+      hasPrevious = true;
+    }
+    total  += current.numElements;
+    before += current.fingerprintBefore;
+    after  += current.fingerprintAfter;
+    slowest = std::max(slowest, current.duration);
+    largest = std::max(largest, size_t(current.numElements));
+  }
+  valid = valid && total == totalElements && before == after;
+
+  printf("%d worker%s\t%8.3f ms\t%6.1f M elements/s\tlargest share %5.1f%%\t%s\n",
+         int(numWorkers), numWorkers == 1 ? " " : "s", 1000*slowest, totalElements / slowest / 1e6,
+         total > 0 ? 100.0 * largest / total : 0.0, valid ? "ok" : "FAILED");
+  return valid ? 0 : 1;
+}
+
+
+/// fork "numWorkers" local processes connected by Unix domain sockets or TCP (localhost), return number of failed workers
+static int runLocal(size_t totalElements, int numWorkers, bool useTcp)
+{
+  // Unix domain sockets must be created before fork
+  std::vector<std::vector<int> > sockets;
+  if (!useTcp)
+  {
+    sockets = SocketTransport::createLocal(numWorkers);
+    if (sockets.empty())
+    {
+      printf("cannot create sockets\n");
+      return numWorkers;
+    }
+  }
+
+  // TCP: each run uses different ports
+  std::vector<std::string> hosts;
+  int basePort = 20000 + (getpid() % 1000) * 32 + numWorkers;
+  for (int rank = 0; rank < numWorkers; rank++)
+    hosts.push_back("127.0.0.1:" + std::to_string(basePort + rank));
+
+  fflush(stdout);
+  std::vector<pid_t> children;
+  for (int rank = 0; rank < numWorkers; rank++)
+  {
+    pid_t child = fork();
+    if (child == 0)
+    {
+      std::vector<int> peers;
+      if (useTcp)
+        peers = SocketTransport::connectTcp(rank, hosts);
+      else
+      {
+        SocketTransport::closeOthers(sockets, rank);
+        peers = sockets[rank];
+      }
+      if (peers.empty())
+      {
+        printf("worker %d: cannot connect\n", rank);
+        _exit(1);
+      }
+
+      int result;
+      {
+        SocketTransport transport(rank, peers);
+        result = runWorker(transport, totalElements);
+      }
+      fflush(stdout);
+      _exit(result);
+    }
+    children.push_back(child);
+  }
+
+  // parent doesn't need any sockets
+  for (auto& row : sockets)
+    for (auto handle : row)
+      if (handle >= 0)
+        close(handle);
+
+  int failed = 0;
+  for (auto child : children)
+  {
+    int status = 0;
+    if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      failed++;
+  }
+  return failed;
+}
+
+
+int main(int argc, char** argv)
+{
+  // one worker of a cluster
+  if (argc >= 4 && strcmp(argv[1], "worker") == 0)
+  {
+    int rank = atoi(argv[2]);
+    std::vector<std::string> hosts;
+    std::string list = argv[3];
+    for (size_t from = 0; from <= list.size(); )
+    {
+      auto comma = list.find(',', from);
+      if (comma == std::string::npos)
+        comma = list.size();
+      hosts.push_back(list.substr(from, comma - from));
+      from = comma + 1;
+    }
+    size_t numElements = argc >= 5 ? strtoull(argv[4], NULL, 10) : 10000000;
+    if (rank < 0 || rank >= int(hosts.size()))
+    {
+      printf("invalid rank %d\n", rank);
+      return 1;
+    }
+
+    auto peers = SocketTransport::connectTcp(rank, hosts);
+    if (peers.empty())
+    {
+      printf("cannot connect to all workers\n");
+      return 1;
+    }
+    SocketTransport transport(rank, peers);
+    return runWorker(transport, numElements);
+  }
+
+  // scaling on this machine
+  size_t numElements = argc >= 2 ? strtoull(argv[1], NULL, 10) : 10000000;
+  int    maxWorkers  = argc >= 3 ? atoi(argv[2]) : 4;
+  bool   useTcp      = argc >= 4 && strcmp(argv[3], "tcp") == 0;
+  if (numElements == 0 || maxWorkers <= 0)
+  {
+    printf("usage: %s [numElements] [maxWorkers] [unix|tcp]\n"
+           "       %s worker <rank> <host:port,host:port,...> [numElements]\n", argv[0], argv[0]);
+    return 1;
+  }
+
+  printf("%llu integers, %s\n", (unsigned long long)numElements, useTcp ? "TCP (localhost)" : "Unix domain sockets");
+  int failed = 0;
+  for (int numWorkers = 1; numWorkers <= maxWorkers; numWorkers++)
+    failed += runLocal(numElements, numWorkers, useTcp);
+
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,435 @@
+// //////////////////////////////////////////////////////////
+// distsort.h
+// Copyright (c) 2020 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+// sort data which is spread across multiple processes (one machine or a cluster), Linux/POSIX only
+// each worker calls distributedSort() with its local share of the data:
+// 1. pick random samples, all workers receive all samples and select the same splitters
+// 2. send each element to the worker responsible for its range (all-to-all exchange)
+// 3. sort the received elements with sort.h's autoSort
+// => worker i holds a sorted range and all its elements are not larger than any element of worker i+1
+//
+// the transport is pluggable: SocketTransport connects all workers either via Unix domain sockets
+// (socketpair before fork, see SocketTransport::createLocal) or via TCP (SocketTransport::connectTcp)
+
+#pragma once
+
+#include "sort.h"
+
+#include <algorithm> // std::find, std::upper_bound
+#include <cstdint>   // uint64_t
+#include <cstdlib>   // atoi
+#include <cstring>   // memcpy, memset
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+
+/// exchange data between workers
+class Transport
+{
+public:
+  virtual ~Transport() {}
+
+  /// this worker's number (0 ... numWorkers() - 1)
+  virtual int rank() const = 0;
+  /// number of workers
+  virtual int numWorkers() const = 0;
+
+  /// send outgoing[i] to worker i and receive incoming[i] from worker i (own data is just copied),
+  /// all workers must call it at the same time, return false on error
+  virtual bool allToAll(const std::vector<std::vector<char> >& outgoing, std::vector<std::vector<char> >& incoming) = 0;
+
+  /// wait until all workers arrive
+  bool barrier()
+  {
+    std::vector<std::vector<char> > nothing(numWorkers()), received;
+    return allToAll(nothing, received);
+  }
+};
+
+
+/// all workers are connected to each other with stream sockets (Unix domain or TCP)
+class SocketTransport : public Transport
+{
+public:
+  /// take ownership of connected sockets, peers[rank] is unused (-1)
+  SocketTransport(int rank, const std::vector<int>& peers)
+  : myRank(rank), peers(peers)
+  {
+    for (auto handle : peers)
+      if (handle >= 0)
+        fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK);
+  }
+
+  /// close all sockets
+  ~SocketTransport()
+  {
+    for (auto handle : peers)
+      if (handle >= 0)
+        close(handle);
+  }
+
+  int rank()       const { return myRank; }
+  int numWorkers() const { return int(peers.size()); }
+
+  /// connect "numWorkers" workers on the same host with Unix domain sockets, call before fork(),
+  /// result[i][j] is worker i's socket to worker j => after fork() worker i keeps result[i] and closes all others
+  static std::vector<std::vector<int> > createLocal(int numWorkers)
+  {
+    std::vector<std::vector<int> > result(numWorkers, std::vector<int>(numWorkers, -1));
+    for (int i = 0; i < numWorkers; i++)
+      for (int j = i + 1; j < numWorkers; j++)
+      {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+          return std::vector<std::vector<int> >();
+        result[i][j] = pair[0];
+        result[j][i] = pair[1];
+      }
+    return result;
+  }
+
+  /// close all sockets which don't belong to worker "rank" (after fork)
+  static void closeOthers(std::vector<std::vector<int> >& sockets, int rank)
+  {
+    for (int i = 0; i < int(sockets.size()); i++)
+      if (i != rank)
+        for (auto handle : sockets[i])
+          if (handle >= 0)
+            close(handle);
+  }
+
+  /// connect via TCP, "hosts" contains "host:port" of all workers (including this one),
+  /// listens on its own port, connects to all workers with a lower rank and accepts connections from all others,
+  /// return an empty vector on error
+  static std::vector<int> connectTcp(int rank, const std::vector<std::string>& hosts, int timeoutSeconds = 30)
+  {
+    int numWorkers = int(hosts.size());
+    std::vector<int> result(numWorkers, -1);
+
+    // listen on own port
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port        = htons(port(hosts[rank]));
+    if (listener < 0 || bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, numWorkers) != 0)
+    {
+      if (listener >= 0)
+        close(listener);
+      return std::vector<int>();
+    }
+
+    // connect to lower ranks and introduce myself, they might not listen yet => retry
+    bool ok = true;
+    for (int peer = 0; peer < rank && ok; peer++)
+    {
+      for (int attempt = 0; attempt < 100 * timeoutSeconds; attempt++)
+      {
+        result[peer] = connectTo(hosts[peer]);
+        if (result[peer] >= 0)
+          break;
+        usleep(10000);
+      }
+      ok = result[peer] >= 0 && writeAll(result[peer], &rank, sizeof(rank));
+    }
+
+    // accept higher ranks
+    for (int accepted = rank + 1; accepted < numWorkers && ok; accepted++)
+    {
+      int handle = accept(listener, NULL, NULL);
+      int peer   = -1;
+      ok = handle >= 0 && readAll(handle, &peer, sizeof(peer)) && peer > rank && peer < numWorkers && result[peer] < 0;
+      if (ok)
+        result[peer] = handle;
+      else if (handle >= 0)
+        close(handle);
+    }
+    close(listener);
+
+    if (!ok)
+    {
+      for (auto handle : result)
+        if (handle >= 0)
+          close(handle);
+      return std::vector<int>();
+    }
+
+    // avoid delays of small messages (samples, barriers)
+    for (auto handle : result)
+      if (handle >= 0)
+        setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    return result;
+  }
+
+  /// send and receive at the same time (non-blocking sockets + poll) => no deadlocks, no matter how much data is exchanged,
+  /// each message is prefixed by its size (8 bytes)
+  bool allToAll(const std::vector<std::vector<char> >& outgoing, std::vector<std::vector<char> >& incoming)
+  {
+    size_t numPeers = peers.size();
+    if (outgoing.size() != numPeers)
+      return false;
+
+    incoming.assign(numPeers, std::vector<char>());
+    incoming[myRank] = outgoing[myRank];
+
+    // progress of each connection
+    std::vector<uint64_t> sendHeader(numPeers), receiveHeader(numPeers, 0);
+    std::vector<size_t>   sent(numPeers, 0), received(numPeers, 0);
+    std::vector<bool>     sendDone(numPeers, false), receiveDone(numPeers, false);
+    sendDone[myRank] = receiveDone[myRank] = true;
+    for (size_t peer = 0; peer < numPeers; peer++)
+      sendHeader[peer] = outgoing[peer].size();
+
+    const size_t HeaderSize = sizeof(uint64_t);
+    std::vector<pollfd> waiting;
+    while (true)
+    {
+      waiting.clear();
+      for (size_t peer = 0; peer < numPeers; peer++)
+      {
+        short events = (sendDone[peer] ? 0 : POLLOUT) | (receiveDone[peer] ? 0 : POLLIN);
+        if (events != 0)
+        {
+          pollfd entry = { peers[peer], events, 0 };
+          waiting.push_back(entry);
+        }
+      }
+      if (waiting.empty())
+        return true;
+
+      if (poll(waiting.data(), waiting.size(), -1) < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+
+      for (auto& entry : waiting)
+      {
+        size_t peer = std::find(peers.begin(), peers.end(), entry.fd) - peers.begin();
+        if (entry.revents & (POLLERR | POLLNVAL))
+          return false;
+
+        // send header, then payload
+        if (entry.revents & POLLOUT)
+        {
+          const char* header = (const char*)&sendHeader[peer];
+          size_t total = HeaderSize + outgoing[peer].size();
+          while (sent[peer] < total)
+          {
+            const char* from = sent[peer] < HeaderSize ? header + sent[peer] : outgoing[peer].data() + (sent[peer] - HeaderSize);
+            size_t      size = sent[peer] < HeaderSize ? HeaderSize - sent[peer] : total - sent[peer];
+            ssize_t     done = send(peers[peer], from, size, MSG_NOSIGNAL);
+            if (done < 0)
+            {
+              if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                break;
+              return false;
+            }
+            sent[peer] += done;
+          }
+          sendDone[peer] = sent[peer] == total;
+        }
+
+        // receive header, then payload
+        if (entry.revents & (POLLIN | POLLHUP))
+        {
+          while (!receiveDone[peer])
+          {
+            bool   inHeader = received[peer] < HeaderSize;
+            char*  to   = inHeader ? (char*)&receiveHeader[peer] + received[peer] : incoming[peer].data() + (received[peer] - HeaderSize);
+            size_t size = inHeader ? HeaderSize - received[peer] : HeaderSize + receiveHeader[peer] - received[peer];
+            ssize_t done = recv(peers[peer], to, size, 0);
+            if (done == 0)
+              return false; // peer disconnected
+            if (done < 0)
+            {
+              if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                break;
+              return false;
+            }
+            received[peer] += done;
+            if (received[peer] == HeaderSize)
+              incoming[peer].resize(receiveHeader[peer]);
+            receiveDone[peer] = received[peer] >= HeaderSize && received[peer] == HeaderSize + receiveHeader[peer];
+          }
+        }
+      }
+    }
+  }
+
+private:
+  /// port number of "host:port"
+  static int port(const std::string& host)
+  {
+    auto colon = host.rfind(':');
+    return colon == std::string::npos ? 0 : atoi(host.c_str() + colon + 1);
+  }
+
+  /// connect to "host:port", return socket or -1
+  static int connectTo(const std::string& host)
+  {
+    auto colon = host.rfind(':');
+    if (colon == std::string::npos)
+      return -1;
+    std::string name    = host.substr(0, colon);
+    std::string service = host.substr(colon + 1);
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = NULL;
+    if (getaddrinfo(name.c_str(), service.c_str(), &hints, &addresses) != 0)
+      return -1;
+
+    int handle = socket(AF_INET, SOCK_STREAM, 0);
+    if (handle >= 0 && connect(handle, addresses->ai_addr, addresses->ai_addrlen) != 0)
+    {
+      close(handle);
+      handle = -1;
+    }
+    freeaddrinfo(addresses);
+    return handle;
+  }
+
+  /// blocking write of a few bytes (during connection setup)
+  static bool writeAll(int handle, const void* data, size_t size)
+  {
+    return write(handle, data, size) == ssize_t(size);
+  }
+
+  /// blocking read of a few bytes (during connection setup)
+  static bool readAll(int handle, void* data, size_t size)
+  {
+    return recv(handle, data, size, MSG_WAITALL) == ssize_t(size);
+  }
+
+  /// this worker's number
+  int myRank;
+  /// sockets of all other workers (peers[myRank] is -1)
+  std::vector<int> peers;
+};
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// serialize trivially copyable elements
+template <typename Value>
+void appendBytes(std::vector<char>& bytes, const Value* first, size_t numElements)
+{
+  bytes.insert(bytes.end(), (const char*)first, (const char*)(first + numElements));
+}
+
+
+/// deserialize trivially copyable elements (memcpy: "bytes" might not be aligned)
+template <typename Value>
+void appendElements(std::vector<Value>& elements, const std::vector<char>& bytes)
+{
+  size_t offset = elements.size();
+  elements.resize(offset + bytes.size() / sizeof(Value));
+  if (!bytes.empty())
+    memcpy(&elements[offset], bytes.data(), bytes.size());
+}
+
+
+/// sort "data" across all workers, allow user-defined less-than operator:
+/// afterwards "data" contains this worker's sorted range, ranges are ordered by rank (elements must be trivially copyable)
+/// "oversampling" random samples per worker determine the splitters, return false if the transport failed
+/// note: if most elements are equal then a single worker may end up with most of them
+template <typename Value, typename LessThan>
+bool distributedSort(std::vector<Value>& data, Transport& transport, LessThan lessThan, size_t oversampling = 64)
+{
+  static_assert(std::is_trivially_copyable<Value>::value, "distributedSort sends raw bytes");
+
+  size_t numWorkers = transport.numWorkers();
+  if (numWorkers == 1)
+  {
+    autoSort(data.begin(), data.end(), lessThan);
+    return true;
+  }
+
+  // pick samples (deterministic pseudo-random positions)
+  std::vector<Value> samples;
+  uint64_t seed = 0x9E3779B97F4A7C15ULL * (transport.rank() + 1);
+  for (size_t i = 0; i < oversampling && !data.empty(); i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    samples.push_back(data[(seed >> 33) % data.size()]);
+  }
+
+  // everybody gets all samples
+  std::vector<std::vector<char> > outgoing(numWorkers), incoming;
+  for (auto& bytes : outgoing)
+    appendBytes(bytes, samples.data(), samples.size());
+  if (!transport.allToAll(outgoing, incoming))
+    return false;
+
+  // same splitters on all workers: every numWorkers-th sample
+  samples.clear();
+  for (auto& bytes : incoming)
+    appendElements(samples, bytes);
+  quickSortIterative(samples.begin(), samples.end(), lessThan);
+  std::vector<Value> splitters;
+  for (size_t i = 1; i < numWorkers && !samples.empty(); i++)
+    splitters.push_back(samples[i * samples.size() / numWorkers]);
+
+  // bucket each element: worker i receives all elements in [splitters[i-1], splitters[i])
+  std::vector<size_t> destination(data.size());
+  std::vector<size_t> count(numWorkers, 0);
+  for (size_t i = 0; i < data.size(); i++)
+  {
+    destination[i] = std::upper_bound(splitters.begin(), splitters.end(), data[i], lessThan) - splitters.begin();
+    count[destination[i]]++;
+  }
+  std::vector<size_t> written(numWorkers, 0);
+  for (size_t worker = 0; worker < numWorkers; worker++)
+    outgoing[worker].resize(count[worker] * sizeof(Value));
+  for (size_t i = 0; i < data.size(); i++)
+  {
+    auto worker = destination[i];
+    memcpy(&outgoing[worker][written[worker]], &data[i], sizeof(Value));
+    written[worker] += sizeof(Value);
+  }
+  std::vector<size_t>().swap(destination);
+  std::vector<Value> ().swap(data);
+
+  // all-to-all exchange
+  if (!transport.allToAll(outgoing, incoming))
+    return false;
+  outgoing.clear();
+
+  // local sort
+  for (auto& bytes : incoming)
+  {
+    appendElements(data, bytes);
+    std::vector<char>().swap(bytes);
+  }
+  autoSort(data.begin(), data.end(), lessThan);
+  return true;
+}
+
+
+/// sort "data" across all workers with default less-than operator
+template <typename Value>
+bool distributedSort(std::vector<Value>& data, Transport& transport)
+{
+  return distributedSort(data, transport, std::less<Value>());
+}
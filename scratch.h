@@ -0,0 +1,277 @@
+// //////////////////////////////////////////////////////////
+// scratch.h
+// Copyright (c) 2020 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+// scratch memory for sort algorithms which need additional memory (Merge Sort, Radix Sort, ...)
+// - large buffers are backed by huge pages (Linux: MAP_HUGETLB, else transparent huge pages via madvise)
+//   => far fewer dTLB misses when randomly accessing multi-GB arrays
+// - each thread keeps its buffer for the next call => no repeated mmap / page faults
+// - pages are pre-faulted by a background thread while the sort algorithm already starts working
+//   (Linux with MADV_POPULATE_WRITE only, one thread whenever a thread's buffer grows)
+// other platforms fall back to malloc/free
+
+#pragma once
+
+#include <cstddef>      // size_t
+#include <cstdint>      // uintptr_t
+#include <cstdlib>      // malloc, free
+#include <new>          // std::bad_alloc
+#include <system_error> // std::system_error
+#include <thread>       // std::thread
+#include <type_traits>  // std::is_trivially_copyable, std::is_default_constructible
+#include <utility>      // std::move
+#include <vector>       // std::vector
+
+#ifdef __linux__
+#include <sys/mman.h>   // mmap, munmap, madvise
+#endif
+
+
+/// thread-local pool of huge-page scratch memory (raw bytes, nothing is constructed)
+class ScratchPool
+{
+public:
+  /// smaller buffers are not worth the effort (one huge page on x86-64)
+  static const size_t MinBytes = 2 * 1024 * 1024;
+
+  /// get at least "numBytes" bytes, reuses this thread's buffer if it's large enough and not in use
+  static void* acquire(size_t numBytes)
+  {
+    numBytes = roundUp(numBytes);
+
+    // nested request (e.g. sortByKey => Radix Sort) ? => separate allocation, not cached
+    Block& block = cached();
+    if (block.inUse)
+      return allocate(numBytes);
+
+    // too small ? => replace
+    if (block.numBytes < numBytes)
+    {
+      block.clear();
+      block.memory   = allocate(numBytes);
+      block.numBytes = numBytes;
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+      // no thread available ? => let the first access fault in each page
+      try
+      {
+        block.prefault = std::thread(populate, block.memory, numBytes);
+      }
+      catch (const std::system_error&)
+      {
+      }
+#endif
+    }
+
+    block.inUse = true;
+    return block.memory;
+  }
+
+  /// return memory obtained by acquire()
+  static void release(void* memory, size_t numBytes)
+  {
+    Block& block = cached();
+    if (memory == block.memory)
+      block.inUse = false;
+    else
+      deallocate(memory, roundUp(numBytes));
+  }
+
+  /// free this thread's cached buffer (if not in use)
+  static void trim()
+  {
+    Block& block = cached();
+    if (!block.inUse)
+      block.clear();
+  }
+
+private:
+  /// cached buffer of the current thread
+  struct Block
+  {
+    Block() : memory(nullptr), numBytes(0), inUse(false) {}
+    ~Block() { clear(); }
+
+    /// wait for pre-faulting to finish, then unmap
+    void clear()
+    {
+      if (prefault.joinable())
+        prefault.join();
+      if (memory)
+        deallocate(memory, numBytes);
+      memory   = nullptr;
+      numBytes = 0;
+    }
+
+    void*       memory;
+    size_t      numBytes;
+    bool        inUse;
+    std::thread prefault;
+  };
+
+  /// one buffer per thread
+  static Block& cached()
+  {
+    static thread_local Block block;
+    return block;
+  }
+
+  /// multiple of the huge page size
+  static size_t roundUp(size_t numBytes)
+  {
+    return (numBytes + MinBytes - 1) & ~(MinBytes - 1);
+  }
+
+  /// map memory, prefer huge pages (size must be a multiple of MinBytes)
+  static void* allocate(size_t numBytes)
+  {
+#ifdef __linux__
+#ifdef MAP_HUGETLB
+    // explicitly reserved huge pages (fails if the admin didn't set up vm.nr_hugepages)
+    void* memory = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED)
+      return memory;
+#endif
+
+    // transparent huge pages need 2 MB alignment => map a bit more and trim both ends
+    size_t mapped = numBytes + MinBytes;
+    char*  raw    = (char*)mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == (char*)MAP_FAILED)
+      throw std::bad_alloc();
+    char* aligned = (char*)((uintptr_t(raw) + MinBytes - 1) & ~uintptr_t(MinBytes - 1));
+    if (aligned != raw)
+      munmap(raw, aligned - raw);
+    if (aligned + numBytes != raw + mapped)
+      munmap(aligned + numBytes, (raw + mapped) - (aligned + numBytes));
+
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, numBytes, MADV_HUGEPAGE);
+#endif
+    return aligned;
+#else
+    void* memory = malloc(numBytes);
+    if (!memory)
+      throw std::bad_alloc();
+    return memory;
+#endif
+  }
+
+  /// unmap memory
+  static void deallocate(void* memory, size_t numBytes)
+  {
+#ifdef __linux__
+    munmap(memory, numBytes);
+#else
+    (void)numBytes;
+    free(memory);
+#endif
+  }
+
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+  /// fault in all pages without touching their contents (runs in the background while the buffer is already used)
+  /// other platforms: writing would race with the sort algorithm => no background thread at all
+  static void populate(void* memory, size_t numBytes)
+  {
+    madvise(memory, numBytes, MADV_POPULATE_WRITE);
+  }
+#endif
+};
+
+
+/// scratch memory for "numElements" elements:
+/// large buffers of trivially copyable elements come from ScratchPool, everything else from a std::vector
+template <typename Value>
+class ScratchBuffer
+{
+public:
+  /// elements of the std::vector are default-constructed
+  explicit ScratchBuffer(size_t numElements)
+  : memory(nullptr), numElements(numElements), pooled(false)
+  {
+    if (!acquirePooled())
+      construct(nullptr, std::true_type());
+  }
+
+  /// same, but element types without a default constructor are move-constructed from the "numElements" elements
+  /// starting at "source" (e.g. the input of a sort algorithm), which immediately get their values back
+  template <typename iterator>
+  ScratchBuffer(size_t numElements, iterator source)
+  : memory(nullptr), numElements(numElements), pooled(false)
+  {
+    if (!acquirePooled())
+      construct(source, std::is_default_constructible<Value>());
+  }
+
+  ~ScratchBuffer()
+  {
+    if (pooled)
+      ScratchPool::release(memory, numElements * sizeof(Value));
+  }
+
+  /// discard all elements and get "numElements" new ones, same rules as the constructor
+  template <typename iterator>
+  void reset(size_t newNumElements, iterator source)
+  {
+    if (pooled)
+      ScratchPool::release(memory, numElements * sizeof(Value));
+    fallback.clear();
+    memory      = nullptr;
+    numElements = newNumElements;
+    pooled      = false;
+
+    if (!acquirePooled())
+      construct(source, std::is_default_constructible<Value>());
+  }
+
+  Value*       data()        { return memory; }
+  size_t       size()  const { return numElements; }
+  Value*       begin()       { return memory; }
+  Value*       end()         { return memory + numElements; }
+  Value& operator[](size_t index) { return memory[index]; }
+
+private:
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+  /// large buffers of trivially copyable elements: raw memory from ScratchPool, return false if not applicable
+  bool acquirePooled()
+  {
+    if (!std::is_trivially_copyable<Value>::value || numElements * sizeof(Value) < ScratchPool::MinBytes)
+      return false;
+
+    memory = static_cast<Value*>(ScratchPool::acquire(numElements * sizeof(Value)));
+    pooled = true;
+    return true;
+  }
+
+  /// default-construct all elements of the std::vector
+  template <typename iterator>
+  void construct(iterator, std::true_type)
+  {
+    fallback.resize(numElements);
+    memory = fallback.data();
+  }
+
+  /// no default constructor: borrow each element from "source" and move it back right away
+  template <typename iterator>
+  void construct(iterator source, std::false_type)
+  {
+    fallback.reserve(numElements);
+    for (size_t i = 0; i < numElements; i++, ++source)
+    {
+      fallback.push_back(std::move(*source));
+      *source = std::move(fallback.back());
+    }
+    memory = fallback.data();
+  }
+
+  /// first element
+  Value* memory;
+  /// number of elements
+  size_t numElements;
+  /// true if memory came from ScratchPool
+  bool   pooled;
+  /// small buffers and non-trivial elements
+  std::vector<Value> fallback;
+};
@@ -12,12 +12,15 @@
 
 #include <vector>
 #include <list>
+#include <forward_list>
+#include <string>
 #include <algorithm> // std::sort, std::reverse
 
 #include "sort.h"
 
 
 // add -DCHECKRESULT to GCC's command-line => then results will be checked whether they are properly sorted
+// add -DPERFCOUNTERS (Linux only) => show hardware performance counters, too
 
 
 // datatype to be sorted
@@ -38,7 +41,7 @@ typedef std::vector<Number> Container;
 
 // protect server from overload:
 // disable a few very slow benchmark when more than RestrictedSort elements
-const int RestrictedSort =   25000;
+const int RestrictedSort = SortTuningRestrictedSort;
 // upper limit, no sorts beyond this number of elements
 const int MaxSort        = 1000000;
 
@@ -69,6 +72,279 @@ static double seconds()
 }
 
 
+#ifdef PERFCOUNTERS
+#include <cstring>   // memset
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// read a hardware performance counter of the current process (Linux only)
+class PerfCounter
+{
+public:
+  /// open counter, e.g. PERF_TYPE_HARDWARE and PERF_COUNT_HW_BRANCH_MISSES
+  PerfCounter(unsigned int type, unsigned long long config)
+  {
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size           = sizeof(attributes);
+    attributes.type           = type;
+    attributes.config         = config;
+    attributes.disabled       = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv     = 1;
+    handle = int(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+  }
+  /// close counter
+  ~PerfCounter()
+  {
+    if (handle >= 0)
+      close(handle);
+  }
+
+  /// reset and start counting
+  void start()
+  {
+    if (handle < 0)
+      return;
+    ioctl(handle, PERF_EVENT_IOC_RESET,  0);
+    ioctl(handle, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  /// stop counting and return number of events (or -1 if not supported)
+  long long stop()
+  {
+    if (handle < 0)
+      return -1;
+    ioctl(handle, PERF_EVENT_IOC_DISABLE, 0);
+    long long result = -1;
+    if (read(handle, &result, sizeof(result)) != sizeof(result))
+      return -1;
+    return result;
+  }
+
+private:
+  /// file descriptor
+  int handle;
+};
+
+
+/// count branch mispredictions of a sort algorithm for random data
+template <typename Sorter>
+static void branchMisses(const char* name, Sorter sorter, const Container& random)
+{
+  PerfCounter counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  Container data = random;
+  counter.start();
+  sorter(data);
+  long long misses = counter.stop();
+  if (misses < 0)
+    printf("%s\tn/a branch misses\n", name);
+  else
+    printf("%s\t%lld branch misses\n", name, misses);
+}
+
+
+/// count dTLB load misses of a sort algorithm for random data
+template <typename Sorter>
+static void dtlbMisses(const char* name, Sorter sorter, const Container& random)
+{
+  PerfCounter counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                          (PERF_COUNT_HW_CACHE_OP_READ     <<  8) |
+                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  Container data = random;
+  counter.start();
+  sorter(data);
+  long long misses = counter.stop();
+  if (misses < 0)
+    printf("%s\tn/a dTLB misses\n", name);
+  else
+    printf("%s\t%lld dTLB misses\n", name, misses);
+}
+#endif // PERFCOUNTERS
+
+
+/// measure a sort algorithm on an arbitrary container, print sorted/inverted/random/total timings
+template <typename Data, typename Sorter>
+static void benchmark(const char* name, Sorter sorter,
+                      const Data& ascending, const Data& descending, const Data& random)
+{
+  // sorted data
+  Data data = ascending;
+  double timeSorted = seconds();
+  sorter(data);
+  timeSorted = fabs(seconds() - timeSorted);
+
+  // inverted data
+  data = descending;
+  double timeInverted = seconds();
+  sorter(data);
+  timeInverted = fabs(seconds() - timeInverted);
+
+#ifdef CHECKRESULT
+  if (data != ascending)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  // random data
+  data = random;
+  double timeRandom = seconds();
+  sorter(data);
+  timeRandom = fabs(seconds() - timeRandom);
+
+#ifdef CHECKRESULT
+  if (!std::is_sorted(data.begin(), data.end()))
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  printf("%s\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\n",
+         name, 1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom));
+}
+
+
+#if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+/// sort in steps of "budget" comparisons, return total time and longest step in "maxPause"
+static double resumableSort(Container& data, size_t budget, double& maxPause)
+{
+  double start = seconds();
+  ResumableSort<Container::iterator> sorter(data.begin(), data.end());
+  bool finished = false;
+  while (!finished)
+  {
+    double stepStart = seconds();
+    finished = sorter.step(budget);
+    double pause = seconds() - stepStart;
+    if (maxPause < pause)
+      maxPause = pause;
+  }
+  return fabs(seconds() - start);
+}
+#endif // !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+
+
+/// sort many tiny arrays of the given sizes (stored back-to-back), return average nanoseconds per call
+template <typename Sorter>
+static double nanosecondsPerCall(const std::vector<Number>& input, const std::vector<size_t>& sizes, Sorter sorter)
+{
+  auto data = input;
+  double start = seconds();
+  auto current = data.begin();
+  for (auto size : sizes)
+  {
+    sorter(current, current + size);
+    current += size;
+  }
+  double duration = fabs(seconds() - start);
+
+#ifdef CHECKRESULT
+  current = data.begin();
+  for (auto size : sizes)
+  {
+    if (!std::is_sorted(current, current + size))
+      printf("Sorting problem @ %d ", __LINE__);
+    current += size;
+  }
+#endif // CHECKRESULT
+
+  return 1e9 * duration / sizes.size();
+}
+
+
+#ifdef CHECKRESULT
+/// stability test: a record's key is sorted, its sequence number shows the original position
+struct Record
+{
+  int key;
+  int seq;
+};
+struct RecordLess
+{
+  bool operator()(const Record& a, const Record& b) const { return a.key < b.key; }
+};
+
+
+/// sort records with a few distinct keys, equal keys must keep their sequence numbers' order if SortTraits claims stability
+template <typename Algorithm, typename Records>
+static void checkStability(const char* name, std::true_type)
+{
+  const int NumRecords = 1000;
+  const int Distinct[] = { 1, 2, 10, 100, NumRecords };
+  for (auto distinct : Distinct)
+  {
+    std::vector<Record> input(NumRecords);
+    for (int i = 0; i < NumRecords; i++)
+    {
+      input[i].key = rand() % distinct;
+      input[i].seq = i;
+    }
+    Records data(input.begin(), input.end());
+
+    Algorithm()(data.begin(), data.end(), RecordLess());
+
+    bool first = true;
+    Record previous = { 0, 0 };
+    for (auto& current : data)
+    {
+      if (!first && (current.key < previous.key ||
+                     (SortTraits<Algorithm>::stable && current.key == previous.key && current.seq < previous.seq)))
+      {
+        printf("Stability problem @ %d (%s) ", __LINE__, name);
+        break;
+      }
+      previous = current;
+      first    = false;
+    }
+  }
+}
+
+/// container's iterators not supported by the algorithm
+template <typename Algorithm, typename Records>
+static void checkStability(const char*, std::false_type)
+{
+}
+
+/// run stability test for arrays, doubly and singly linked lists (as far as the algorithm supports them)
+template <typename Algorithm>
+static void checkStability(const char* name)
+{
+  checkStability<Algorithm, std::vector      <Record> >(name, SortSupports<Algorithm, std::vector      <Record>::iterator>());
+  checkStability<Algorithm, std::list        <Record> >(name, SortSupports<Algorithm, std::list        <Record>::iterator>());
+  checkStability<Algorithm, std::forward_list<Record> >(name, SortSupports<Algorithm, std::forward_list<Record>::iterator>());
+}
+#endif // CHECKRESULT
+
+
+#if defined(CHECKRESULT) && defined(__unix__)
+#include <pthread.h>
+#include <climits>   // PTHREAD_STACK_MIN
+
+/// thread function: iterative Quick Sort of a container
+static void* quickSortIterativeThread(void* container)
+{
+  Container& data = *static_cast<Container*>(container);
+  quickSortIterative(data.begin(), data.end());
+  return NULL;
+}
+
+/// run iterative Quick Sort on a thread with a tiny stack (crashes if the stack isn't bounded), false if no thread was created
+static bool quickSortIterativeSmallStack(Container& data, size_t stackSize)
+{
+  if (stackSize < size_t(PTHREAD_STACK_MIN))
+    stackSize = PTHREAD_STACK_MIN;
+
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstacksize(&attributes, stackSize);
+  pthread_t thread;
+  bool created = pthread_create(&thread, &attributes, quickSortIterativeThread, &data) == 0;
+  if (created)
+    pthread_join(thread, NULL);
+  pthread_attr_destroy(&attributes);
+  return created;
+}
+#endif // defined(CHECKRESULT) && defined(__unix__)
+
+
 int main(int argc, char** argv)
 {
   // number of elements to be sorted
@@ -112,7 +388,13 @@ int main(int argc, char** argv)
 #ifdef CHECKRESULT
   Container sorted = ascending;
   Container sortedRandom = random;
-  std::sort(sortedRandom.begin(), sortedRandom.end());
+  // std::sort requires random-access iterators => sort a copy
+  std::vector<Number> sortedCopy(numElements);
+  for (int i = 0; i < numElements; i++)
+    sortedCopy[i] = random[i];
+  std::sort(sortedCopy.begin(), sortedCopy.end());
+  for (int i = 0; i < numElements; i++)
+    sortedRandom[i] = sortedCopy[i];
 #endif // CHECKRESULT
 
   // use this container for input data
@@ -254,6 +536,13 @@ int main(int argc, char** argv)
   else
     // skip bubble sort in order to prevent server overload
     printf("Insertion Sort\t%8.3f ms\tn/a\tn/a\tn/a\n", 1000*timeSorted);
+
+  // binary InsertionSort: O(n log n) comparisons but still O(n^2) moves
+  if (numElements < RestrictedSort)
+    benchmark("Binary Insertion Sort", [](Container& data) { binaryInsertionSort(data.begin(), data.end()); },
+              ascending, descending, random);
+  else
+    printf("Binary Insertion Sort\tn/a\tn/a\tn/a\tn/a\n");
 #endif // FORWARDITERATOR
 
 
@@ -296,8 +585,7 @@ int main(int argc, char** argv)
 #endif // FORWARDITERATOR
 
 
-#ifndef FORWARDITERATOR
-  // QuickSort
+  // QuickSort (forward iterators: Lomuto partitioning)
   // inverted data
   data = descending;
   timeInverted = seconds();
@@ -332,7 +620,77 @@ int main(int argc, char** argv)
 
   printf("Quick Sort\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\n",
          1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom));
-#endif // FORWARDITERATOR
+
+
+  // iterative QuickSort
+  // inverted data
+  data = descending;
+  timeInverted = seconds();
+  quickSortIterative(data.begin(), data.end());
+  timeInverted = fabs(seconds() - timeInverted);
+
+#ifdef CHECKRESULT
+  if (data != sorted)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  // sorted data
+  timeSorted = seconds();
+  quickSortIterative(data.begin(), data.end());
+  timeSorted = fabs(seconds() - timeSorted);
+
+#ifdef CHECKRESULT
+  if (data != sorted)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  // random data
+  data = random;
+  timeRandom = seconds();
+  quickSortIterative(data.begin(), data.end());
+  timeRandom = fabs(seconds() - timeRandom);
+
+#ifdef CHECKRESULT
+  if (data != sortedRandom)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  printf("Quick Sort (iterative)\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\n",
+         1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom));
+
+#if defined(CHECKRESULT) && defined(__unix__)
+  // bounded stack and no quadratic slowdown with many duplicates: sorted data with duplicates and all elements equal
+  {
+    const size_t StackSize = 32 * 1024;
+    Container duplicates(numElements);
+    Container equal(numElements);
+    for (int i = 0; i < numElements; i++)
+    {
+      duplicates[i] = Number(i / 16);
+      equal[i]      = Number(7);
+    }
+
+    data = duplicates;
+    double timeDuplicates = seconds();
+    bool created = quickSortIterativeSmallStack(data, StackSize);
+    timeDuplicates = fabs(seconds() - timeDuplicates);
+    if (created && data != duplicates)
+      printf("Sorting problem @ %d ", __LINE__);
+
+    data = equal;
+    double timeEqual = seconds();
+    created = created && quickSortIterativeSmallStack(data, StackSize);
+    timeEqual = fabs(seconds() - timeEqual);
+    if (created && data != equal)
+      printf("Sorting problem @ %d ", __LINE__);
+
+    if (created)
+      printf("Quick Sort (iterative, 32 KB stack)\t%8.3f ms\t%8.3f ms\t(sorted with duplicates, all equal)\n",
+             1000*timeDuplicates, 1000*timeEqual);
+    else
+      printf("Quick Sort (iterative, 32 KB stack)\tn/a (no thread)\n");
+  }
+#endif // defined(CHECKRESULT) && defined(__unix__)
 
 
 #ifndef FORWARDITERATOR
@@ -374,6 +732,108 @@ int main(int argc, char** argv)
 #endif // FORWARDITERATOR
 
 
+#if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+  // AutoSort
+  AutoSortThresholds thresholds;
+  printf("Auto Sort thresholds: smallSize=%d maxUnsorted=%.3f maxMovesPerElement=%d minDuplicates=%.3f minRadixSize=%d maxRadixBits=%d\n",
+         int(thresholds.smallSize), thresholds.maxUnsorted, int(thresholds.maxMovesPerElement),
+         thresholds.minDuplicates, int(thresholds.minRadixSize), int(thresholds.maxRadixBits));
+
+  // inverted data
+  data = descending;
+  timeInverted = seconds();
+  AutoSortChoice choiceInverted = autoSort(data.begin(), data.end());
+  timeInverted = fabs(seconds() - timeInverted);
+
+#ifdef CHECKRESULT
+  if (data != sorted)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  // sorted data
+  timeSorted = seconds();
+  AutoSortChoice choiceSorted = autoSort(data.begin(), data.end());
+  timeSorted = fabs(seconds() - timeSorted);
+
+#ifdef CHECKRESULT
+  if (data != sorted)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  // random data
+  data = random;
+  timeRandom = seconds();
+  AutoSortChoice choiceRandom = autoSort(data.begin(), data.end());
+  timeRandom = fabs(seconds() - timeRandom);
+
+#ifdef CHECKRESULT
+  if (data != sortedRandom)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  printf("Auto Sort\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\t(%s / %s / %s)\n",
+         1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom),
+         autoSortName(choiceSorted), autoSortName(choiceInverted), autoSortName(choiceRandom));
+
+  // heavy hitter: about 30% of all elements share the same key (too few for three-way Quick Sort),
+  // a user-defined less-than operator prevents Radix Sort
+  Container heavyHitter = random;
+  for (auto& x : heavyHitter)
+    if (rand() % 10 < 3)
+      x = Number(RAND_MAX / 2);
+  auto numberLess = [](const Number& a, const Number& b) { return a < b; };
+
+  data = heavyHitter;
+  double timeHeavyHitter = seconds();
+  AutoSortChoice choiceHeavyHitter = autoSort(data.begin(), data.end(), numberLess);
+  timeHeavyHitter = fabs(seconds() - timeHeavyHitter);
+
+#ifdef CHECKRESULT
+  std::sort(heavyHitter.begin(), heavyHitter.end());
+  if (data != heavyHitter)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  printf("Auto Sort (30%% equal keys)\t%8.3f ms\t(%s)\n", 1000*timeHeavyHitter, autoSortName(choiceHeavyHitter));
+#endif // !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+
+
+#if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+  // resumable Quick Sort, at most about 10000 comparisons per step
+  const size_t StepBudget = 10000;
+  double maxPause = 0;
+
+  // inverted data
+  data = descending;
+  timeInverted = resumableSort(data, StepBudget, maxPause);
+
+#ifdef CHECKRESULT
+  if (data != sorted)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  // sorted data
+  timeSorted = resumableSort(data, StepBudget, maxPause);
+
+#ifdef CHECKRESULT
+  if (data != sorted)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  // random data
+  data = random;
+  timeRandom = resumableSort(data, StepBudget, maxPause);
+
+#ifdef CHECKRESULT
+  if (data != sortedRandom)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  printf("Resumable Sort\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\t(max. pause %.3f ms)\n",
+         1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom), 1000*maxPause);
+#endif // !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+
+
 #if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
   // HeapSort
   // inverted data
@@ -418,7 +878,7 @@ int main(int argc, char** argv)
   // inverted data
   data = descending;
   timeInverted = seconds();
-  naryHeapSort<8>(data.begin(), data.end());
+  naryHeapSort<SortTuningNaryHeapWidth>(data.begin(), data.end());
   timeInverted = fabs(seconds() - timeInverted);
 
 #ifdef CHECKRESULT
@@ -428,7 +888,7 @@ int main(int argc, char** argv)
 
   // sorted data
   timeSorted = seconds();
-  naryHeapSort<8>(data.begin(), data.end());
+  naryHeapSort<SortTuningNaryHeapWidth>(data.begin(), data.end());
   timeSorted = fabs(seconds() - timeSorted);
 
 #ifdef CHECKRESULT
@@ -439,7 +899,7 @@ int main(int argc, char** argv)
   // random data
   data = random;
   timeRandom = seconds();
-  naryHeapSort<8>(data.begin(), data.end());
+  naryHeapSort<SortTuningNaryHeapWidth>(data.begin(), data.end());
   timeRandom = fabs(seconds() - timeRandom);
 
 #ifdef CHECKRESULT
@@ -447,13 +907,12 @@ int main(int argc, char** argv)
     printf("Sorting problem @ %d ", __LINE__);
 #endif // CHECKRESULT
 
-  printf("n-ary Heap Sort (n=8)\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\n",
+  printf("n-ary Heap Sort (n=%d)\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\n", int(SortTuningNaryHeapWidth),
           1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom));
 #endif // !defined(FORWARDITERATOR)
 
 
-#if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
-  // MergeSort
+  // MergeSort (forward iterators: merge with a buffer)
   // inverted data
   data = descending;
   timeInverted = seconds();
@@ -488,7 +947,6 @@ int main(int argc, char** argv)
 
   printf("Merge Sort\t%8.3f ms\t%8.3f ms\t%8.3f ms\t%8.3f ms\n",
           1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom));
-#endif // !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
 
 
   // in-place MergeSort
@@ -534,6 +992,59 @@ int main(int argc, char** argv)
     printf("Merge Sort in-place\t%8.3f ms\tn/a\tn/a\tn/a\n", 1000*timeSorted);
 
 
+  // bottom-up MergeSort, works with forward iterators, too
+  benchmark("Merge Sort (bottom-up)", [](Container& data) { mergeSortBottomUp(data.begin(), data.end()); },
+            ascending, descending, random);
+
+  // fastest stable algorithm for this container (chosen at compile time)
+  benchmark("stableSort", [](Container& data) { stableSort(data.begin(), data.end()); },
+            ascending, descending, random);
+
+
+#if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+  // tiled MergeSort: in-cache tiles and a single K-way merge
+  benchmark("Merge Sort (tiled)", [](Container& data) { mergeSortTiled(data.begin(), data.end()); },
+            ascending, descending, random);
+
+  // effective bandwidth on random data (bytes sorted per second)
+  {
+    double bytes = double(numElements) * sizeof(Number);
+
+    data = random;
+    double timeTiled = seconds();
+    mergeSortTiled(data.begin(), data.end());
+    timeTiled = fabs(seconds() - timeTiled);
+
+    data = random;
+    double timeMerge = seconds();
+    mergeSort(data.begin(), data.end());
+    timeMerge = fabs(seconds() - timeMerge);
+
+    printf("Merge Sort (tiled)\t%8.3f GB/s\n", bytes / timeTiled / 1e9);
+    printf("Merge Sort\t%8.3f GB/s\n",         bytes / timeMerge / 1e9);
+  }
+
+  // only two different values: tiles must not become quadratic
+  {
+    Container twoValues(numElements);
+    for (auto& x : twoValues)
+      x = Number(rand() % 2);
+
+    data = twoValues;
+    double timeTiled = seconds();
+    mergeSortTiled(data.begin(), data.end());
+    timeTiled = fabs(seconds() - timeTiled);
+
+#ifdef CHECKRESULT
+    if (!std::is_sorted(data.begin(), data.end()))
+      printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+    printf("Merge Sort (tiled, 2 different values)\t%8.3f ms\n", 1000*timeTiled);
+  }
+#endif
+
+
 #if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
   // std::sort
   // inverted data
@@ -578,5 +1089,374 @@ int main(int argc, char** argv)
          1000*timeSorted, 1000*timeInverted, 1000*timeRandom, 1000*(timeSorted+timeInverted+timeRandom));
 #endif // !defined(FORWARDITERATOR) && !defined(BIDRECTIONALITERATOR)
 
+
+#ifdef CHECKRESULT
+  // stability: every algorithm must sort (key, seq) records, those flagged as stable must keep equal keys in order
+  checkStability<BubbleSorter>             ("Bubble Sort");
+  checkStability<SelectionSorter>          ("Selection Sort");
+  checkStability<InsertionSorter>          ("Insertion Sort");
+  checkStability<BinaryInsertionSorter>    ("Binary Insertion Sort");
+  checkStability<ShellSorter>              ("Shell Sort");
+  checkStability<HeapSorter>               ("Heap Sort");
+  checkStability<MergeSorter>              ("Merge Sort");
+  checkStability<MergeSorterInPlace>       ("Merge Sort in-place");
+  checkStability<MergeSorterBottomUp>      ("Merge Sort (bottom-up)");
+  checkStability<MergeSorterTiled>         ("Merge Sort (tiled)");
+  checkStability<MergeInsertionSorter>     ("Merge Insertion");
+  checkStability<MergeSorterMinComparisons>("Merge Sort (min. comparisons)");
+  checkStability<QuickSorter>              ("Quick Sort");
+  checkStability<QuickSorterIterative>     ("Quick Sort (iterative)");
+  checkStability<QuickSorter3Way>          ("three-way Quick Sort");
+  checkStability<IntroSorter>              ("Intro Sort");
+  checkStability<SmallSorter>              ("Small Sort");
+  checkStability<AutoSorter>               ("Auto Sort");
+  checkStability<StableSorter<std::vector      <Record>::iterator, RecordLess>::type>("stableSort (array)");
+  checkStability<StableSorter<std::list        <Record>::iterator, RecordLess>::type>("stableSort (list)");
+  checkStability<StableSorter<std::forward_list<Record>::iterator, RecordLess>::type>("stableSort (forward list)");
+
+  // bounded priority queue: keep the 10 biggest elements, pop them in ascending order
+  {
+    const int K = 10;
+    StreamingTopK<Number, K> topK;
+    topK.add(random.begin(), random.end());
+    int expected = numElements > K ? numElements - K : 0;
+    for (; !topK.empty(); topK.pop(), expected++)
+      if (!(topK.top() == sortedRandom[expected]))
+      {
+        printf("Sorting problem @ %d ", __LINE__);
+        break;
+      }
+    if (expected != numElements)
+      printf("Sorting problem @ %d ", __LINE__);
+  }
+#endif // CHECKRESULT
+
+
+#ifndef LESSTHAN
+  // verified sorting: parallel isSorted and a fingerprint of all elements before and after sorting
+  {
+    typedef decltype(data.begin()) DataIterator;
+    auto quickSorter = [](DataIterator first, DataIterator last, std::less<Number> lessThan) { quickSort(first, last, lessThan); };
+
+    data = random;
+    double timeSort = seconds();
+    quickSort(data.begin(), data.end());
+    timeSort = fabs(seconds() - timeSort);
+
+    data = random;
+    double timeVerified = seconds();
+    bool verified = verifiedSort(data.begin(), data.end(), quickSorter);
+    timeVerified = fabs(seconds() - timeVerified);
+
+    // check the sorted data once more
+    auto expected = fingerprint(random.begin(), random.end());
+    double timeCheck = seconds();
+    verified = verified && isSorted(data.begin(), data.end()) && fingerprint(data.begin(), data.end()) == expected;
+    timeCheck = fabs(seconds() - timeCheck);
+
+    printf("Quick Sort (verified)\t%8.3f ms\t%8.3f ms\t(isSorted + fingerprint: %.3f ms, %s)\n",
+           1000*timeSort, 1000*timeVerified, 1000*timeCheck, verified ? "ok" : "failed");
+
+#ifdef CHECKRESULT
+    if (!verified)
+      printf("Sorting problem @ %d ", __LINE__);
+
+    // a broken algorithm which duplicates an element must be detected
+    if (numElements >= 2)
+    {
+      data = random;
+      auto brokenSorter = [](DataIterator first, DataIterator last, std::less<Number> lessThan)
+                          { quickSort(first, last, lessThan); auto second = first; *++second = *first; };
+      if (verifiedSort(data.begin(), data.end(), brokenSorter) && !(sortedRandom[0] == sortedRandom[1]))
+        printf("Sorting problem @ %d ", __LINE__);
+    }
+#endif // CHECKRESULT
+  }
+#endif // LESSTHAN
+
+
+  // floating-point numbers: std::less isn't a strict weak ordering if NaNs are involved (undefined behavior, may crash),
+  // floatSort and FloatLess sort integer keys which are derived from the IEEE-754 bit patterns
+  {
+    const char* distributionNames[] = { "doubles", "doubles, 1% NaN", "doubles, 50% NaN", "doubles, signed zeros + 10% NaN" };
+    const int   nanPercent[]        = { 0, 1, 50, 10 };
+    for (int distribution = 0; distribution < 4; distribution++)
+    {
+      std::vector<double> floats(numElements);
+      for (auto& x : floats)
+      {
+        int percent = rand() % 100;
+        if (percent < nanPercent[distribution])
+          x = (rand() & 1) ? NAN : std::copysign(NAN, -1.0);
+        else if (distribution == 3 && percent < 50)
+          x = (rand() & 1) ? 0.0 : -0.0;
+        else
+          x = (rand() - RAND_MAX/2) / double(rand() + 1);
+      }
+
+      std::vector<double> sortedFloats = floats;
+      double timeFloatSort = seconds();
+      floatSort(sortedFloats.begin(), sortedFloats.end());
+      timeFloatSort = fabs(seconds() - timeFloatSort);
+
+      std::vector<double> copy = floats;
+      double timeFloatLess = seconds();
+      std::sort(copy.begin(), copy.end(), FloatLess<double>());
+      timeFloatLess = fabs(seconds() - timeFloatLess);
+
+      // std::less is only allowed without NaNs
+      if (nanPercent[distribution] == 0)
+      {
+        copy = floats;
+        double timeLess = seconds();
+        std::sort(copy.begin(), copy.end());
+        timeLess = fabs(seconds() - timeLess);
+        printf("floatSort (%s)\t%8.3f ms\t(std::sort + FloatLess: %.3f ms, std::sort: %.3f ms)\n",
+               distributionNames[distribution], 1000*timeFloatSort, 1000*timeFloatLess, 1000*timeLess);
+      }
+      else
+        printf("floatSort (%s)\t%8.3f ms\t(std::sort + FloatLess: %.3f ms, std::sort: n/a)\n",
+               distributionNames[distribution], 1000*timeFloatSort, 1000*timeFloatLess);
+
+#ifdef CHECKRESULT
+      // ascending, all NaNs at the end, no element lost
+      size_t numNaN = 0;
+      for (auto x : floats)
+        if (std::isnan(x))
+          numNaN++;
+      bool ok = std::is_sorted(sortedFloats.begin(), sortedFloats.end(), FloatLess<double>()) &&
+                fingerprint(sortedFloats.begin(), sortedFloats.end()) == fingerprint(floats.begin(), floats.end());
+      for (size_t i = 0; i < numNaN; i++)
+        ok = ok && std::isnan(sortedFloats[numElements - 1 - i]);
+      if (!ok)
+        printf("Sorting problem @ %d ", __LINE__);
+
+      // NaNs at the front, -0.0 before +0.0
+      copy = floats;
+      floatSort(copy.begin(), copy.end(), FloatSortNaNFirst, FloatSortNegativeZeroFirst);
+      for (size_t i = 0; i < numNaN; i++)
+        ok = ok && std::isnan(copy[i]);
+      for (size_t i = numNaN + 1; i < copy.size(); i++)
+        ok = ok && !(copy[i] < copy[i - 1]) && !(std::signbit(copy[i - 1]) == false && std::signbit(copy[i]) && copy[i] == 0);
+      if (!ok)
+        printf("Sorting problem @ %d ", __LINE__);
+
+      // linked lists fall back to Merge Sort
+      std::list<double> floatList(floats.begin(), floats.end());
+      floatSort(floatList.begin(), floatList.end());
+      if (!std::is_sorted(floatList.begin(), floatList.end(), FloatLess<double>()))
+        printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+    }
+  }
+
+
+#if defined(PERFCOUNTERS) && !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR) && !defined(LESSTHAN)
+  // branch-free block partitioning is only used for cheap comparisons (std::less),
+  // a custom less-than operator enforces the classic partitioning scheme
+  struct CustomLess { bool operator()(const Number& a, const Number& b) const { return a < b; } };
+  printf("random data:\n");
+  branchMisses("Quick Sort (block partition)",   [](Container& data) { quickSort(data.begin(), data.end()); }, random);
+  branchMisses("Quick Sort (classic partition)", [](Container& data) { quickSort(data.begin(), data.end(), CustomLess()); }, random);
+  branchMisses("Intro Sort (block partition)",   [](Container& data) { introSort(data.begin(), data.end()); }, random);
+  branchMisses("Intro Sort (classic partition)", [](Container& data) { introSort(data.begin(), data.end(), CustomLess()); }, random);
+  branchMisses("std::sort",                      [](Container& data) { std::sort(data.begin(), data.end()); }, random);
+
+  // scratch memory: huge pages (ScratchPool, reused across calls) vs. regular 4 KB pages (fresh std::vector)
+  dtlbMisses("Radix Sort (huge page scratch)", [](Container& data) { radixSort(data.begin(), data.end()); }, random);
+  dtlbMisses("Radix Sort (std::vector scratch)", [](Container& data)
+             { std::vector<Number> scratch(data.size()); radixSort(data.begin(), data.end(), scratch.data()); }, random);
+  dtlbMisses("Merge Sort (bottom-up, huge page scratch)", [](Container& data) { mergeSortBottomUp(data.begin(), data.end()); }, random);
+#endif // PERFCOUNTERS
+
+
+#if !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+  // strings with long common prefixes (URL-like)
+  printf("%d string%s\n", numElements, numElements == 1 ? "":"s");
+  std::vector<std::string> ascendingStrings(numElements);
+  for (int i = 0; i < numElements; i++)
+  {
+    char url[64];
+    snprintf(url, sizeof(url), "https://create.stephan-brumme.com/item/%010d", i);
+    ascendingStrings[i] = url;
+  }
+  std::vector<std::string> descendingStrings(ascendingStrings.rbegin(), ascendingStrings.rend());
+  std::vector<std::string> randomStrings(numElements);
+  for (int i = 0; i < numElements; i++)
+    randomStrings[i] = ascendingStrings[rand() % numElements];
+
+  benchmark("Intro Sort",          [](std::vector<std::string>& data) { introSort        (data.begin(), data.end()); },
+            ascendingStrings, descendingStrings, randomStrings);
+  benchmark("Multikey Quick Sort", [](std::vector<std::string>& data) { multikeyQuickSort(data.begin(), data.end()); },
+            ascendingStrings, descendingStrings, randomStrings);
+  benchmark("String Radix Sort",   [](std::vector<std::string>& data) { stringRadixSort  (data.begin(), data.end()); },
+            ascendingStrings, descendingStrings, randomStrings);
+  benchmark("LCP Merge Sort",      [](std::vector<std::string>& data) { lcpMergeSort     (data.begin(), data.end()); },
+            ascendingStrings, descendingStrings, randomStrings);
+  benchmark("std::sort",           [](std::vector<std::string>& data) { std::sort        (data.begin(), data.end()); },
+            ascendingStrings, descendingStrings, randomStrings);
+
+
+  // linked lists
+  printf("%d list element%s\n", numElements, numElements == 1 ? "":"s");
+  std::list<Number> ascendingList, descendingList, randomList;
+  for (int i = 0; i < numElements; i++)
+  {
+    ascendingList .push_back(ascending [i]);
+    descendingList.push_back(descending[i]);
+    randomList    .push_back(random    [i]);
+  }
+
+  benchmark("Quick Sort",       [](std::list<Number>& data) { quickSort(data.begin(), data.end()); },
+            ascendingList, descendingList, randomList);
+  benchmark("List Merge Sort",  [](std::list<Number>& data) { listMergeSort(data); },
+            ascendingList, descendingList, randomList);
+  benchmark("std::list::sort",  [](std::list<Number>& data) { data.sort(); },
+            ascendingList, descendingList, randomList);
+#endif // !defined(FORWARDITERATOR) && !defined(BIDIRECTIONALITERATOR)
+
+
+  // many tiny arrays: fixed sizes and a mix (20% with 1..4 elements, 70% with 5..40 elements, 10% with 41..64 elements)
+  typedef std::vector<Number>::iterator TinyIterator;
+  printf("%d tiny arrays\tsmallSort\tIntro Sort\tstd::sort\n", numElements);
+  const int TinySizes[] = { 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 0 }; // 0 => mix
+  for (auto tinySize : TinySizes)
+  {
+    std::vector<size_t> sizes(numElements);
+    for (auto& size : sizes)
+    {
+      size = tinySize;
+      if (tinySize == 0)
+      {
+        int percent = rand() % 100;
+        if (percent < 20)
+          size = 1 + rand() % 4;
+        else if (percent < 90)
+          size = 5 + rand() % 36;
+        else
+          size = 41 + rand() % 24;
+      }
+    }
+
+    size_t total = 0;
+    for (auto size : sizes)
+      total += size;
+    std::vector<Number> tiny(total);
+    for (auto& x : tiny)
+      x = Number(rand());
+
+    double timeSmall = nanosecondsPerCall(tiny, sizes, [](TinyIterator first, TinyIterator last) { smallSort(first, last); });
+    double timeIntro = nanosecondsPerCall(tiny, sizes, [](TinyIterator first, TinyIterator last) { introSort(first, last); });
+    double timeStd   = nanosecondsPerCall(tiny, sizes, [](TinyIterator first, TinyIterator last) { std::sort(first, last); });
+    if (tinySize == 0)
+      printf("mix\t%8.1f ns\t%8.1f ns\t%8.1f ns\n", timeSmall, timeIntro, timeStd);
+    else
+      printf("n=%d\t%8.1f ns\t%8.1f ns\t%8.1f ns\n", tinySize, timeSmall, timeIntro, timeStd);
+  }
+
+
+  // parallel arrays: keys and 32 bit payload ids vs. an array of std::pair
+  printf("%d key-value pair%s\n", numElements, numElements == 1 ? "":"s");
+  typedef std::pair<Number, unsigned int> KeyValue;
+  std::vector<Number>       keys  (numElements);
+  std::vector<unsigned int> values(numElements);
+  std::vector<KeyValue>     pairs (numElements);
+  for (int i = 0; i < numElements; i++)
+  {
+    keys  [i] = random[i];
+    values[i] = i;
+    pairs [i] = KeyValue(keys[i], values[i]);
+  }
+  auto pairLess = [](const KeyValue& a, const KeyValue& b) { return a.first < b.first; };
+
+  double timeByKey = seconds();
+  sortByKey(keys.begin(), keys.end(), values.begin());
+  timeByKey = fabs(seconds() - timeByKey);
+
+  auto pairsCopy = pairs;
+  double timePairsIntro = seconds();
+  introSort(pairsCopy.begin(), pairsCopy.end(), pairLess);
+  timePairsIntro = fabs(seconds() - timePairsIntro);
+
+  pairsCopy = pairs;
+  double timePairsStd = seconds();
+  std::sort(pairsCopy.begin(), pairsCopy.end(), pairLess);
+  timePairsStd = fabs(seconds() - timePairsStd);
+
+#ifdef CHECKRESULT
+  if (!std::is_sorted(keys.begin(), keys.end()))
+    printf("Sorting problem @ %d ", __LINE__);
+  for (int i = 0; i < numElements; i++)
+    if (!(keys[i] == random[values[i]]))
+      printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  printf("Sort by key (two arrays)\t%8.3f ms\n", 1000*timeByKey);
+  printf("Intro Sort (std::pair)\t%8.3f ms\n",   1000*timePairsIntro);
+  printf("std::sort (std::pair)\t%8.3f ms\n",    1000*timePairsStd);
+
+
+  // only 100 different values: sort and remove duplicates / count duplicates
+  printf("%d elements with 100 different values\n", numElements);
+  std::vector<Number> fewDistinct(numElements);
+  for (auto& x : fewDistinct)
+    x = Number(rand() % 100);
+  // neighbors of sorted data are equal if the left one isn't smaller
+  auto isEqualSorted = [](const Number& a, const Number& b) { return !(a < b); };
+
+  auto unique = fewDistinct;
+  double timeSortUnique = seconds();
+  unique.erase(sortUnique(unique.begin(), unique.end()), unique.end());
+  timeSortUnique = fabs(seconds() - timeSortUnique);
+
+  // Intro Sort is very slow when there are many duplicates
+  auto introUnique = fewDistinct;
+  double timeIntroUnique = 0;
+  if (numElements < RestrictedSort)
+  {
+    timeIntroUnique = seconds();
+    introSort(introUnique.begin(), introUnique.end());
+    introUnique.erase(std::unique(introUnique.begin(), introUnique.end(), isEqualSorted), introUnique.end());
+    timeIntroUnique = fabs(seconds() - timeIntroUnique);
+  }
+
+  auto stdUnique = fewDistinct;
+  double timeStdUnique = seconds();
+  std::sort(stdUnique.begin(), stdUnique.end());
+  stdUnique.erase(std::unique(stdUnique.begin(), stdUnique.end(), isEqualSorted), stdUnique.end());
+  timeStdUnique = fabs(seconds() - timeStdUnique);
+
+  // group-by: count each value
+  std::vector<KeyValue> counters(numElements);
+  for (int i = 0; i < numElements; i++)
+    counters[i] = KeyValue(fewDistinct[i], 1);
+  double timeSortReduce = seconds();
+  counters.erase(sortReduce(counters.begin(), counters.end(), pairLess,
+                            [](KeyValue& a, const KeyValue& b) { a.second += b.second; }), counters.end());
+  timeSortReduce = fabs(seconds() - timeSortReduce);
+
+#ifdef CHECKRESULT
+  if (unique != stdUnique || counters.size() != stdUnique.size() ||
+      (numElements < RestrictedSort && introUnique != stdUnique))
+    printf("Sorting problem @ %d ", __LINE__);
+  unsigned int total = 0;
+  for (size_t i = 0; i < counters.size(); i++)
+  {
+    total += counters[i].second;
+    if (!(counters[i].first == stdUnique[i]))
+      printf("Sorting problem @ %d ", __LINE__);
+  }
+  if (total != (unsigned int)numElements)
+    printf("Sorting problem @ %d ", __LINE__);
+#endif // CHECKRESULT
+
+  printf("Sort Unique\t%8.3f ms\n",                    1000*timeSortUnique);
+  if (numElements < RestrictedSort)
+    printf("Intro Sort + std::unique\t%8.3f ms\n",     1000*timeIntroUnique);
+  else
+    printf("Intro Sort + std::unique\tn/a\n");
+  printf("std::sort + std::unique\t%8.3f ms\n",        1000*timeStdUnique);
+  printf("Sort Reduce (count duplicates)\t%8.3f ms\n", 1000*timeSortReduce);
+
   return 0;
 }
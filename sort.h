@@ -10,17 +10,95 @@
 // i.e.: quickSort(container.begin(), container.end());
 //
 // They sort the container in-place.
-// All but merge sort require no significant additional memory
+// All but merge sort and LCP merge sort require no significant additional memory
 // (just some stack for a few variable and maybe a copy of a single element).
 //
 // You can provide your own less-than operator, too
 // i.e.: quickSort(container.begin(), container.end(), myless());
+//
+// Algorithms which need additional memory accept a caller-provided scratch buffer
+// or (C++17) a std::pmr::memory_resource, too. Passing NoAlloc() instead guarantees
+// that no heap memory is allocated: either an in-place strategy is chosen
+// or compilation fails if the algorithm can't work without additional memory.
+// i.e.: mergeSort(container.begin(), container.end(), myless(), NoAlloc());
 
 #pragma once
 
 #include <algorithm>  // std::iter_swap
 #include <iterator>   // std::advance, std::iterator_traits
 #include <functional> // std::less
+#include <type_traits> // std::is_integral, std::make_unsigned
+#include <cstdint>     // uint32_t
+#include <cstring>     // memmove, memcpy
+#include <limits>      // std::numeric_limits
+#include <new>         // placement new
+#include <thread>      // std::thread
+#if defined(__SSE2__) && defined(__x86_64__)
+#include <emmintrin.h> // _mm_stream_si32, _mm_stream_si64
+#endif
+
+// machine-specific thresholds, re-generate by running ./calibrate on the target machine
+#include "sort_tuning.h"
+// huge-page scratch memory, reused across calls
+#include "scratch.h"
+#include <vector>     // std::vector
+#include <list>       // std::list
+#if __cplusplus >= 201703L
+#include <memory_resource> // std::pmr::memory_resource
+#endif
+
+
+/// policy: algorithm must not allocate any heap memory
+struct NoAlloc {};
+
+
+/// true if iterator refers to contiguous memory (raw pointers and std::vector's iterators, except std::vector<bool>)
+template <typename iterator, typename Value = typename std::iterator_traits<iterator>::value_type>
+struct IsContiguousIterator : std::integral_constant<bool,
+                                std::is_pointer<iterator>::value ||
+                                (!std::is_same<Value, bool>::value &&
+                                 (std::is_same<iterator, typename std::vector<Value>::iterator>::value ||
+                                  std::is_same<iterator, typename std::vector<Value>::const_iterator>::value))> {};
+
+/// true if a block of elements can be shifted with memmove
+template <typename iterator>
+struct UseMemmove : std::integral_constant<bool,
+                      IsContiguousIterator<iterator>::value &&
+                      std::is_trivially_copyable<typename std::iterator_traits<iterator>::value_type>::value> {};
+
+
+/// true if comparing two elements is cheap (arithmetic types with std::less or std::greater)
+template <typename T, typename LessThan>
+struct IsCheapComparison : std::integral_constant<bool,
+                             std::is_arithmetic<T>::value &&
+                             (std::is_same<LessThan, std::less<T> >::value || std::is_same<LessThan, std::greater<T> >::value)> {};
+
+
+/// swap two values if the second is smaller, compiles to conditional moves (no branches) for cheap comparisons
+template <typename T, typename LessThan>
+void conditionalSwap(T& a, T& b, LessThan lessThan, std::true_type)
+{
+  bool isSmaller = lessThan(b, a);
+  T    smaller   = isSmaller ? b : a;
+  T    larger    = isSmaller ? a : b;
+  a = smaller;
+  b = larger;
+}
+
+/// swap two values if the second is smaller
+template <typename T, typename LessThan>
+void conditionalSwap(T& a, T& b, LessThan lessThan, std::false_type)
+{
+  if (lessThan(b, a))
+    std::swap(a, b);
+}
+
+/// swap two values if the second is smaller, branch-free for cheap comparisons
+template <typename T, typename LessThan>
+void conditionalSwap(T& a, T& b, LessThan lessThan)
+{
+  conditionalSwap(a, b, lessThan, IsCheapComparison<T, LessThan>());
+}
 
 
 /// Bubble Sort, allow user-defined less-than operator
@@ -119,9 +197,9 @@ void selectionSort(iterator first, iterator last)
 // /////////////////////////////////////////////////////////////////////
 
 
-/// Insertion Sort, allow user-defined less-than operator
+/// Insertion Sort, shift elements one by one
 template <typename iterator, typename LessThan>
-void insertionSort(iterator first, iterator last, LessThan lessThan)
+void insertionSort(iterator first, iterator last, LessThan lessThan, std::false_type)
 {
   if (first == last)
     return;
@@ -151,9 +229,8 @@ void insertionSort(iterator first, iterator last, LessThan lessThan)
       pos  = std::move( left); // same as --pos
     }
 
-    // found final position
-    if (pos != current)
-      *pos = std::move(compare);
+    // found final position (always write back, "compare" was moved out of "current")
+    *pos = std::move(compare);
 
     // sort next element
     ++current;
@@ -161,6 +238,53 @@ void insertionSort(iterator first, iterator last, LessThan lessThan)
 }
 
 
+/// Insertion Sort for contiguous trivially copyable elements: raw pointers, memmove for long shifts
+template <typename iterator, typename LessThan>
+void insertionSort(iterator first, iterator last, LessThan lessThan, std::true_type)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  if (first == last)
+    return;
+
+  auto   data        = &*first;
+  size_t numElements = last - first;
+  for (size_t current = 1; current < numElements; current++)
+  {
+    // already at its final position ? (typical for presorted data)
+    auto compare = data[current];
+    if (!lessThan(compare, data[current - 1]))
+      continue;
+
+    // new minimum ? => shift whole sorted range at once (typical for inverted data)
+    if (lessThan(compare, data[0]))
+    {
+      memmove(data + 1, data, current * sizeof(Value));
+      data[0] = compare;
+      continue;
+    }
+
+    // find location inside sorted range, beginning from the right end
+    // no bounds check needed because data[0] is not larger than "compare"
+    auto pos = current;
+    do
+    {
+      data[pos] = data[pos - 1];
+      pos--;
+    } while (lessThan(compare, data[pos - 1]));
+
+    data[pos] = compare;
+  }
+}
+
+
+/// Insertion Sort, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+void insertionSort(iterator first, iterator last, LessThan lessThan)
+{
+  insertionSort(first, last, lessThan, UseMemmove<iterator>());
+}
+
+
 /// Insertion Sort with default less-than operator
 template <typename iterator>
 void insertionSort(iterator first, iterator last)
@@ -169,6 +293,83 @@ void insertionSort(iterator first, iterator last)
 }
 
 
+/// binary Insertion Sort: gallop from the right end of the sorted range, then binary search => O(log i) comparisons,
+/// each element is shifted with a single std::move_backward (memmove for trivially copyable types)
+template <typename iterator, typename LessThan>
+void binaryInsertionSort(iterator first, iterator last, LessThan lessThan, std::random_access_iterator_tag)
+{
+  size_t numElements = last - first;
+  for (size_t current = 1; current < numElements; current++)
+  {
+    // already at its final position ? (typical for presorted data)
+    if (!lessThan(first[current], first[current - 1]))
+      continue;
+
+    auto compare = std::move(first[current]);
+
+    // gallop: probe 1, 2, 4, 8, ... positions to the left of first[high] which is larger than "compare"
+    // => nearly sorted data needs only a few comparisons
+    size_t low  = 0;
+    size_t high = current - 1;
+    for (size_t step = 1; step <= high; step *= 2)
+    {
+      size_t probe = high - step;
+      if (!lessThan(compare, first[probe]))
+      {
+        low = probe + 1;
+        break;
+      }
+      high = probe;
+    }
+
+    // binary search in [low, high), insert after equal elements (=> stable)
+    auto pos = std::upper_bound(first + low, first + high, compare, lessThan);
+    std::move_backward(pos, first + current, first + current + 1);
+    *pos = std::move(compare);
+  }
+}
+
+
+/// binary search needs random access => plain Insertion Sort for forward and bidirectional iterators
+template <typename iterator, typename LessThan>
+void binaryInsertionSort(iterator first, iterator last, LessThan lessThan, std::forward_iterator_tag)
+{
+  insertionSort(first, last, lessThan);
+}
+
+
+/// binary Insertion Sort, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+void binaryInsertionSort(iterator first, iterator last, LessThan lessThan)
+{
+  binaryInsertionSort(first, last, lessThan, typename std::iterator_traits<iterator>::iterator_category());
+}
+
+
+/// binary Insertion Sort with default less-than operator
+template <typename iterator>
+void binaryInsertionSort(iterator first, iterator last)
+{
+  binaryInsertionSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// sort a small range: cheap comparisons favor the linear scan of Insertion Sort, expensive ones binary Insertion Sort
+template <typename iterator, typename LessThan>
+void insertionSortByCost(iterator first, iterator last, LessThan lessThan, std::true_type)
+{
+  insertionSort(first, last, lessThan);
+}
+
+
+/// sort a small range: expensive comparisons => binary Insertion Sort
+template <typename iterator, typename LessThan>
+void insertionSortByCost(iterator first, iterator last, LessThan lessThan, std::false_type)
+{
+  binaryInsertionSort(first, last, lessThan);
+}
+
+
 // /////////////////////////////////////////////////////////////////////
 
 
@@ -276,6 +477,146 @@ void heapSort(iterator first, iterator last)
 // /////////////////////////////////////////////////////////////////////
 
 
+/// n-ary heap: move element at position "pos" down until the heap property holds for the first "stop" elements
+/// the biggest element is located at the front
+template <size_t Width, typename iterator, typename LessThan>
+void narySiftDown(iterator first, size_t pos, size_t stop, LessThan lessThan)
+{
+  std::advance(first, pos);
+  auto parent = first;
+  auto child  = first;
+
+  auto value = std::move(*parent);
+
+  while (pos * Width + 1 < stop)
+  {
+    // locate children
+    auto increment = pos * (Width - 1) + 1;
+    pos += increment;
+    std::advance(child, increment);
+
+    // figure out how many children we have to check
+    auto numChildren = Width;
+    if (numChildren + pos > stop)
+      numChildren = stop - pos;
+
+    // find the biggest of them
+    if (numChildren > 1)
+    {
+      iterator scan = child;
+      ++scan;
+
+      size_t maxPos = 0;
+      for (size_t i = 1; i < numChildren; i++, scan++)
+        // element in "scan" bigger than current best ?
+        if (lessThan(*child, *scan))
+        {
+          maxPos = i;
+          child = scan;
+        }
+
+      pos += maxPos;
+    }
+
+    // is no child bigger than the parent ? => done
+    if (!lessThan(value, *child))
+    {
+      *parent = std::move(value);
+      return;
+    }
+
+    // move biggest child one level up, parent one level down and continue
+    *parent = std::move(*child);
+    parent  =            child;
+  }
+
+  *child = std::move(value);
+}
+
+
+/// n-ary heap: move element at position "pos" up until the heap property holds
+template <size_t Width, typename iterator, typename LessThan>
+void narySiftUp(iterator first, size_t pos, LessThan lessThan)
+{
+  auto current = first;
+  std::advance(current, pos);
+  auto value = std::move(*current);
+
+  while (pos > 0)
+  {
+    auto parentPos = (pos - 1) / Width;
+    auto parent = first;
+    std::advance(parent, parentPos);
+
+    // parent not smaller ? => done
+    if (!lessThan(*parent, value))
+      break;
+
+    // move parent one level down
+    *current = std::move(*parent);
+    current  = parent;
+    pos      = parentPos;
+  }
+
+  *current = std::move(value);
+}
+
+
+/// n-ary heap: arrange all elements such that the biggest is in front (like std::make_heap)
+template <size_t Width, typename iterator, typename LessThan>
+void makeHeap(iterator first, iterator last, LessThan lessThan)
+{
+  static_assert(Width >= 2, "heap width must be at least two");
+
+  size_t numElements = std::distance(first, last);
+  if (numElements < 2)
+    return;
+
+  size_t firstLeaf = (numElements + Width - 2) / Width;
+  for (size_t i = firstLeaf; i > 0; i--)
+    narySiftDown<Width>(first, i - 1, numElements, lessThan);
+}
+
+
+/// n-ary heap: [first,last-1) is a heap, add the element at last-1 (like std::push_heap)
+template <size_t Width, typename iterator, typename LessThan>
+void pushHeap(iterator first, iterator last, LessThan lessThan)
+{
+  static_assert(Width >= 2, "heap width must be at least two");
+
+  size_t numElements = std::distance(first, last);
+  if (numElements >= 2)
+    narySiftUp<Width>(first, numElements - 1, lessThan);
+}
+
+
+/// n-ary heap: move the biggest element to last-1 and turn [first,last-1) into a heap (like std::pop_heap)
+template <size_t Width, typename iterator, typename LessThan>
+void popHeap(iterator first, iterator last, LessThan lessThan)
+{
+  static_assert(Width >= 2, "heap width must be at least two");
+
+  size_t numElements = std::distance(first, last);
+  if (numElements < 2)
+    return;
+
+  --last;
+  std::iter_swap(first, last);
+  narySiftDown<Width>(first, 0, numElements - 1, lessThan);
+}
+
+
+/// n-ary heap: replace the biggest element by "value" and restore the heap property
+template <size_t Width, typename iterator, typename T, typename LessThan>
+void replaceTop(iterator first, iterator last, T&& value, LessThan lessThan)
+{
+  static_assert(Width >= 2, "heap width must be at least two");
+
+  *first = std::forward<T>(value);
+  narySiftDown<Width>(first, 0, std::distance(first, last), lessThan);
+}
+
+
 /// n-ary Heap Sort, allow user-defined less-than operator
 template <size_t Width, typename iterator, typename LessThan>
 void naryHeapSort(iterator first, iterator last, LessThan lessThan)
@@ -286,6 +627,8 @@ void naryHeapSort(iterator first, iterator last, LessThan lessThan)
     naryHeapSort<2>(first, last, lessThan);
     return;
   }
+  // avoid instantiating the heap functions with invalid widths
+  const size_t SafeWidth = Width < 2 ? 2 : Width;
 
   auto numElements = std::distance(first, last);
   if (numElements < 2)
@@ -293,66 +636,8 @@ void naryHeapSort(iterator first, iterator last, LessThan lessThan)
 
   // based on n-ary heap sort pseudo code from http://de.wikipedia.org/wiki/Heapsort
 
-  struct SiftDown
-  {
-    void operator() (iterator first, size_t pos, size_t stop, LessThan lessThan)
-    {
-      std::advance(first, pos);
-      auto parent = first;
-      auto child  = first;
-
-      auto value = std::move(*parent);
-
-      while (pos * Width + 1 < stop)
-      {
-        // locate children
-        auto increment = pos * (Width - 1) + 1;
-        pos += increment;
-        std::advance(child, increment);
-
-        // figure out how many children we have to check
-        auto numChildren = Width;
-        if (numChildren + pos > stop)
-          numChildren = stop - pos;
-
-        // find the biggest of them
-        if (numChildren > 1)
-        {
-          iterator scan = child;
-          ++scan;
-
-          size_t maxPos = 0;
-          for (size_t i = 1; i < numChildren; i++, scan++)
-            // element in "scan" bigger than current best ?
-            if (lessThan(*child, *scan))
-            {
-              maxPos = i;
-              child = scan;
-            }
-
-          pos += maxPos;
-        }
-
-        // is no child bigger than the parent ? => done
-        if (!lessThan(value, *child))
-        {
-          *parent = std::move(value);
-          return;
-        }
-
-        // move biggest child one level up, parent one level down and continue
-        *parent = std::move(*child);
-        parent  =            child;
-      }
-
-      *child = std::move(value);
-    }
-  } heapify;
-
   // build heap where the biggest elements are placed in front
-  size_t firstLeaf = (numElements + Width - 2) / Width;
-  for (size_t i = firstLeaf; i > 0; i--)
-    heapify(first, i - 1, numElements, lessThan);
+  makeHeap<SafeWidth>(first, last, lessThan);
 
   // take heap's largest element and move it to the end
   // => build sorted sequence beginning with last (= largest) element
@@ -361,7 +646,7 @@ void naryHeapSort(iterator first, iterator last, LessThan lessThan)
     --last;
     std::iter_swap(first, last);
     // re-adjust shrinked heap
-    heapify(first, 0, i, lessThan);
+    narySiftDown<SafeWidth>(first, 0, i, lessThan);
   }
 }
 
@@ -377,21 +662,133 @@ void naryHeapSort(iterator first, iterator last)
 // /////////////////////////////////////////////////////////////////////
 
 
+/// keep the K biggest elements of an arbitrarily long input (n-ary min-heap, no heap allocations)
+/// O(log K) per element, use it as a bounded priority queue, too (top/pop return the smallest stored element)
+/// elements are copy-constructed when added, T doesn't need a default constructor
+template <typename T, size_t K, size_t Width = 4, typename LessThan = std::less<T> >
+class StreamingTopK
+{
+  static_assert(K > 0, "StreamingTopK needs room for at least one element");
+
+public:
+  /// create empty container
+  explicit StreamingTopK(LessThan lessThan = LessThan())
+  : numElements(0), greater(lessThan) {}
+
+  /// copy all stored elements
+  StreamingTopK(const StreamingTopK& other)
+  : numElements(0), greater(other.greater)
+  {
+    for (; numElements < other.numElements; numElements++)
+      new (elements() + numElements) T(other.elements()[numElements]);
+  }
+
+  /// replace all stored elements by copies of another container's elements
+  StreamingTopK& operator=(const StreamingTopK& other)
+  {
+    if (this != &other)
+    {
+      clear();
+      greater = other.greater;
+      for (; numElements < other.numElements; numElements++)
+        new (elements() + numElements) T(other.elements()[numElements]);
+    }
+    return *this;
+  }
+
+  /// destroy all stored elements
+  ~StreamingTopK()
+  {
+    clear();
+  }
+
+  /// process a single element
+  void add(const T& value)
+  {
+    if (numElements < K)
+    {
+      new (elements() + numElements) T(value);
+      numElements++;
+      pushHeap<Width>(elements(), elements() + numElements, greater);
+    }
+    else if (greater.lessThan(elements()[0], value))
+      // replace the smallest of the K biggest elements
+      replaceTop<Width>(elements(), elements() + K, value, greater);
+  }
+
+  /// process a sequence of elements (input iterators are sufficient)
+  template <typename InputIterator>
+  void add(InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first)
+      add(*first);
+  }
+
+  /// number of stored elements (at most K)
+  size_t size() const { return numElements; }
+
+  /// true if nothing stored
+  bool empty() const { return numElements == 0; }
+
+  /// smallest of the stored elements (undefined if empty)
+  const T& top() const { return elements()[0]; }
+
+  /// remove the smallest of the stored elements (undefined if empty)
+  void pop()
+  {
+    popHeap<Width>(elements(), elements() + numElements, greater);
+    elements()[--numElements].~T();
+  }
+
+  /// remove all stored elements
+  void clear()
+  {
+    while (numElements > 0)
+      elements()[--numElements].~T();
+  }
+
+  /// return all stored elements, biggest first
+  std::vector<T> result() const
+  {
+    std::vector<T> sorted(elements(), elements() + numElements);
+    naryHeapSort<Width>(sorted.begin(), sorted.end(), greater);
+    return sorted;
+  }
+
+private:
+  /// swap parameters of less-than operator => heap keeps its smallest element in front
+  struct Greater
+  {
+    explicit Greater(LessThan lessThan_) : lessThan(lessThan_) {}
+    bool operator()(const T& a, const T& b) const { return lessThan(b, a); }
+    LessThan lessThan;
+  };
+
+  /// heap storage: the first numElements elements are constructed
+  T*       elements()       { return reinterpret_cast<T*>(storage); }
+  const T* elements() const { return reinterpret_cast<const T*>(storage); }
+
+  /// raw memory for K elements
+  alignas(T) unsigned char storage[K * sizeof(T)];
+  /// number of stored elements
+  size_t numElements;
+  /// inverted less-than operator
+  Greater greater;
+};
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
 /// Merge Sort, allow user-defined less-than operator
 template <typename iterator, typename LessThan>
-void mergeSort(iterator first, iterator last, LessThan lessThan, size_t size = 0)
-{
-  // determine size if not known yet
-  if (size == 0 && first != last)
-    size = std::distance(first, last);
-  // by the way, the size parameter can be omitted but
-  // then we are required to compute it each time which can be expensive
-  // for non-random access iterators
+void mergeSort(iterator first, iterator last, LessThan lessThan, size_t size = 0);
 
-  // one element is always sorted
-  if (size <= 1)
-    return;
 
+/// Merge Sort for bidirectional and random-access iterators, merging is done by std::inplace_merge
+template <typename iterator, typename LessThan>
+void mergeSort(iterator first, iterator last, LessThan lessThan, size_t size, std::bidirectional_iterator_tag)
+{
   // divide into two partitions
   auto firstHalf  = size / 2;
   auto secondHalf = size - firstHalf;
@@ -407,20 +804,15 @@ void mergeSort(iterator first, iterator last, LessThan lessThan, size_t size = 0
 }
 
 
-/// Merge Sort with default less-than operator
-template <typename iterator>
-void mergeSort(iterator first, iterator last)
-{
-  mergeSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
-}
-
-
-// /////////////////////////////////////////////////////////////////////
+/// Merge Sort for forward iterators: std::inplace_merge needs bidirectional iterators
+/// => allocate scratch memory once and merge with the (forward-only) buffered merge
+template <typename iterator, typename LessThan>
+void mergeSort(iterator first, iterator last, LessThan lessThan, size_t size, std::forward_iterator_tag);
 
 
-/// in-place Merge Sort, allow user-defined less-than operator
+/// Merge Sort, allow user-defined less-than operator
 template <typename iterator, typename LessThan>
-void mergeSortInPlace(iterator first, iterator last, LessThan lessThan, size_t size = 0)
+void mergeSort(iterator first, iterator last, LessThan lessThan, size_t size)
 {
   // determine size if not known yet
   if (size == 0 && first != last)
@@ -433,24 +825,219 @@ void mergeSortInPlace(iterator first, iterator last, LessThan lessThan, size_t s
   if (size <= 1)
     return;
 
-  // divide into two partitions
-  auto firstHalf  = size / 2;
-  auto secondHalf = size - firstHalf;
-  auto mid = first;
-  std::advance(mid, firstHalf);
+  mergeSort(first, last, lessThan, size, typename std::iterator_traits<iterator>::iterator_category());
+}
 
-  // recursively sort them
-  mergeSortInPlace(first, mid,  lessThan, firstHalf);
-  mergeSortInPlace(mid,   last, lessThan, secondHalf);
 
-  // merge partitions (left starts at "first", right starts and "mid")
-  // move iterators towards the end until they meet
-  auto right = mid;
-  while (first != mid)
-  {
-    // next value of both partitions in wrong order (smaller one belongs to the left)
-    if (lessThan(*right, *first))
-    {
+/// Merge Sort with default less-than operator
+template <typename iterator>
+void mergeSort(iterator first, iterator last)
+{
+  mergeSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// merge two sorted neighboring ranges, move the left one into "buffer" (which must be large enough)
+template <typename iterator, typename Value, typename LessThan>
+void mergeWithBuffer(iterator first, iterator mid, iterator last, Value* buffer, LessThan lessThan)
+{
+  auto left      = buffer;
+  auto leftEnd   = std::move(first, mid, buffer);
+  auto right     = mid;
+  auto output    = first;
+  while (left != leftEnd && right != last)
+  {
+    // prefer left element if equal (=> stable)
+    if (lessThan(*right, *left))
+      *output++ = std::move(*right++);
+    else
+      *output++ = std::move(*left++);
+  }
+
+  // copy remaining elements of left range, the right range is already at its final position
+  std::move(left, leftEnd, output);
+}
+
+
+/// merge two sorted neighboring ranges without additional memory (rotation-based, stable)
+template <typename iterator, typename LessThan>
+void mergeWithoutBuffer(iterator first, iterator mid, iterator last, size_t sizeLeft, size_t sizeRight, LessThan lessThan)
+{
+  if (sizeLeft == 0 || sizeRight == 0)
+    return;
+
+  // only two elements
+  if (sizeLeft + sizeRight == 2)
+  {
+    if (lessThan(*mid, *first))
+      std::iter_swap(first, mid);
+    return;
+  }
+
+  // split the larger range in half and find the matching split position in the smaller range
+  auto cutLeft  = first;
+  auto cutRight = mid;
+  size_t newSizeLeft, newSizeRight;
+  if (sizeLeft > sizeRight)
+  {
+    newSizeLeft = sizeLeft / 2;
+    std::advance(cutLeft, newSizeLeft);
+    cutRight = std::lower_bound(mid, last, *cutLeft, lessThan);
+    newSizeRight = std::distance(mid, cutRight);
+  }
+  else
+  {
+    newSizeRight = sizeRight / 2;
+    std::advance(cutRight, newSizeRight);
+    cutLeft = std::upper_bound(first, mid, *cutRight, lessThan);
+    newSizeLeft = std::distance(first, cutLeft);
+  }
+
+  // swap the inner blocks and merge both sides
+  auto newMid = std::rotate(cutLeft, mid, cutRight);
+  mergeWithoutBuffer(first,  cutLeft,  newMid, newSizeLeft,            newSizeRight,             lessThan);
+  mergeWithoutBuffer(newMid, cutRight, last,   sizeLeft - newSizeLeft, sizeRight - newSizeRight, lessThan);
+}
+
+
+/// Merge Sort with caller-provided scratch memory (at least half as many elements as the input)
+/// if the scratch buffer is too small or missing then slower in-place merging is used
+template <typename iterator, typename LessThan>
+void mergeSort(iterator first, iterator last, LessThan lessThan,
+               typename std::iterator_traits<iterator>::value_type* scratch, size_t scratchSize,
+               size_t size = 0)
+{
+  // determine size if not known yet
+  if (size == 0 && first != last)
+    size = std::distance(first, last);
+
+  // one element is always sorted
+  if (size <= 1)
+    return;
+
+  // divide into two partitions
+  auto firstHalf  = size / 2;
+  auto secondHalf = size - firstHalf;
+  auto mid = first;
+  std::advance(mid, firstHalf);
+
+  // recursively sort them
+  mergeSort(first, mid,  lessThan, scratch, scratchSize, firstHalf);
+  mergeSort(mid,   last, lessThan, scratch, scratchSize, secondHalf);
+
+  // merge sorted partitions
+  if (firstHalf <= scratchSize)
+    mergeWithBuffer(first, mid, last, scratch, lessThan);
+  else
+    mergeWithoutBuffer(first, mid, last, firstHalf, secondHalf, lessThan);
+}
+
+
+/// Merge Sort for forward iterators: std::inplace_merge needs bidirectional iterators
+/// => allocate scratch memory once and merge with the (forward-only) buffered merge
+template <typename iterator, typename LessThan>
+void mergeSort(iterator first, iterator last, LessThan lessThan, size_t size, std::forward_iterator_tag)
+{
+  ScratchBuffer<typename std::iterator_traits<iterator>::value_type> scratch(size / 2, first);
+  mergeSort(first, last, lessThan, scratch.data(), scratch.size(), size);
+}
+
+
+/// Merge Sort without any heap allocations (in-place merging)
+template <typename iterator, typename LessThan>
+void mergeSort(iterator first, iterator last, LessThan lessThan, NoAlloc)
+{
+  mergeSort(first, last, lessThan, nullptr, 0);
+}
+
+
+#if __cplusplus >= 201703L
+/// Merge Sort, scratch memory is taken from a user-defined memory resource
+template <typename iterator, typename LessThan>
+void mergeSort(iterator first, iterator last, LessThan lessThan, std::pmr::memory_resource* resource)
+{
+  size_t size = std::distance(first, last);
+  std::pmr::vector<typename std::iterator_traits<iterator>::value_type> scratch(size / 2, resource);
+  mergeSort(first, last, lessThan, scratch.data(), scratch.size(), size);
+}
+#endif
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// insert "value" into the sorted range [first+1,last) while shifting all smaller elements one position to the left
+template <typename iterator, typename Value, typename LessThan>
+void insertShiftLeft(iterator first, iterator last, Value& value, LessThan lessThan, std::false_type)
+{
+  auto scan = first;
+  auto next = scan;
+  ++next;
+  // move smaller one position to the left
+  while (next != last && lessThan(*next, value))
+    *scan++ = std::move(*next++);
+
+  // found the spot !
+  *scan = std::move(value);
+}
+
+
+/// insert "value" into the sorted range [first+1,last) while shifting all smaller elements one position to the left,
+/// contiguous trivially copyable elements are shifted with memmove
+template <typename iterator, typename Value, typename LessThan>
+void insertShiftLeft(iterator first, iterator last, Value& value, LessThan lessThan, std::true_type)
+{
+  auto   data        = &*first;
+  size_t numElements = last - first;
+
+  // new maximum ? => avoid scanning the whole range, typical for inverted data
+  size_t pos = numElements;
+  if (!lessThan(data[numElements - 1], value))
+  {
+    pos = 1;
+    while (lessThan(data[pos], value))
+      pos++;
+  }
+
+  // shift all smaller elements at once
+  memmove(data, data + 1, (pos - 1) * sizeof(Value));
+  data[pos - 1] = value;
+}
+
+
+/// in-place Merge Sort, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+void mergeSortInPlace(iterator first, iterator last, LessThan lessThan, size_t size = 0)
+{
+  // determine size if not known yet
+  if (size == 0 && first != last)
+    size = std::distance(first, last);
+  // by the way, the size parameter can be omitted but
+  // then we are required to compute it each time which can be expensive
+  // for non-random access iterators
+
+  // one element is always sorted
+  if (size <= 1)
+    return;
+
+  // divide into two partitions
+  auto firstHalf  = size / 2;
+  auto secondHalf = size - firstHalf;
+  auto mid = first;
+  std::advance(mid, firstHalf);
+
+  // recursively sort them
+  mergeSortInPlace(first, mid,  lessThan, firstHalf);
+  mergeSortInPlace(mid,   last, lessThan, secondHalf);
+
+  // merge partitions (left starts at "first", right starts and "mid")
+  // move iterators towards the end until they meet
+  auto right = mid;
+  while (first != mid)
+  {
+    // next value of both partitions in wrong order (smaller one belongs to the left)
+    if (lessThan(*right, *first))
+    {
       // this value must be moved to the right partition
       auto misplaced = std::move(*first);
 
@@ -458,15 +1045,7 @@ void mergeSortInPlace(iterator first, iterator last, LessThan lessThan, size_t s
       *first = std::move(*right);
 
       // misplaced value must be inserted at correct position in the right partition
-      auto scan = right;
-      auto next = scan;
-      ++next;
-      // move smaller one position to the left
-      while (next != last && lessThan(*next, misplaced))
-        *scan++ = std::move(*next++);
-
-      // found the spot !
-      *scan = std::move(misplaced);
+      insertShiftLeft(right, last, misplaced, lessThan, UseMemmove<iterator>());
     }
 
     ++first;
@@ -485,123 +1064,3139 @@ void mergeSortInPlace(iterator first, iterator last)
 // /////////////////////////////////////////////////////////////////////
 
 
-/// Quick Sort, allow user-defined less-than operator
+/// merge two sorted ranges into "output" (stable), return end of output
+template <typename LeftIterator, typename RightIterator, typename Destination, typename LessThan>
+Destination mergeRuns(LeftIterator left, LeftIterator leftEnd, RightIterator right, RightIterator rightEnd, Destination output, LessThan lessThan)
+{
+  while (left != leftEnd && right != rightEnd)
+  {
+    // prefer left element if equal (=> stable)
+    if (lessThan(*right, *left))
+      *output++ = std::move(*right++);
+    else
+      *output++ = std::move(*left++);
+  }
+  output = std::move(left,  leftEnd,  output);
+  return   std::move(right, rightEnd, output);
+}
+
+
+/// bottom-up Merge Sort sorts blocks of this size with Insertion Sort (random-access iterators only)
+const size_t MergeSortBottomUpBlockSize = 32;
+
+
+/// bottom-up Merge Sort for random-access iterators: Insertion Sort on small blocks,
+/// then merge runs of width 32, 64, 128, ... alternating between input and scratch memory (as many elements as the input)
 template <typename iterator, typename LessThan>
-void quickSort(iterator first, iterator last, LessThan lessThan)
+void mergeSortBottomUp(iterator first, iterator last, LessThan lessThan,
+                       typename std::iterator_traits<iterator>::value_type* scratch, std::random_access_iterator_tag)
 {
-  auto numElements = std::distance(first, last);
-  // already sorted ?
+  const size_t BlockSize = MergeSortBottomUpBlockSize;
+
+  size_t numElements = last - first;
   if (numElements <= 1)
     return;
 
-  auto pivot = last;
-  --pivot;
+  // sort small blocks
+  for (size_t block = 0; block < numElements; block += BlockSize)
+    insertionSort(first + block, first + std::min(block + BlockSize, numElements), lessThan);
+  if (numElements <= BlockSize)
+    return;
 
-  // choose middle element as pivot (good choice for partially sorted data)
-  if (numElements > 2)
+  bool inScratch = false;
+  for (size_t width = BlockSize; width < numElements; width *= 2)
   {
-    auto middle = first;
-    std::advance(middle, numElements/2);
-    std::iter_swap(middle, pivot);
+    // linear sweep over all pairs of neighboring runs
+    for (size_t left = 0; left < numElements; left += 2 * width)
+    {
+      size_t mid   = std::min(left +     width, numElements);
+      size_t right = std::min(left + 2 * width, numElements);
+      if (inScratch)
+        mergeRuns(scratch + left, scratch + mid, scratch + mid, scratch + right, first + left, lessThan);
+      else
+        mergeRuns(first + left, first + mid, first + mid, first + right, scratch + left, lessThan);
+    }
+    inScratch = !inScratch;
   }
 
-  // scan beginning from left and right end and swap misplaced elements
-  auto left  = first;
-  auto right = pivot;
-  while (left != right)
+  if (inScratch)
+    std::move(scratch, scratch + numElements, first);
+}
+
+
+/// bottom-up Merge Sort for forward iterators: merge runs of width 1, 2, 4, ... without knowing the number of elements,
+/// the left run is moved to scratch memory: "getScratch(size)" returns memory for at least "size" elements
+/// ("size" is the current width, but never more than the number of elements, which is known after the first sweep)
+template <typename iterator, typename LessThan, typename GetScratch>
+void mergeSortBottomUpForward(iterator first, iterator last, LessThan lessThan, GetScratch getScratch)
+{
+  if (first == last)
+    return;
+
+  size_t numElements = ~size_t(0);
+  for (size_t width = 1; ; width *= 2)
   {
-    // look for mismatches
-    while (!lessThan(*pivot, *left)  && left != right)
-      ++left;
-    while (!lessThan(*right, *pivot) && left != right)
-      --right;
-    // swap two values which are both on the wrong side of the pivot element
-    if (left != right)
-      std::iter_swap(left, right);
+    auto   scratch    = getScratch(std::min(width, numElements));
+    size_t numScanned = 0;
+    auto   left       = first;
+    while (left != last)
+    {
+      // find end of left run
+      auto   mid     = left;
+      size_t sizeLeft = 0;
+      while (sizeLeft < width && mid != last)
+      {
+        ++mid;
+        sizeLeft++;
+      }
+      numScanned += sizeLeft;
+
+      // no right run ? => done with this sweep
+      if (mid == last)
+      {
+        // all elements were in the left run ? => everything sorted
+        if (left == first)
+          return;
+        break;
+      }
+
+      // find end of right run
+      auto   right     = mid;
+      size_t sizeRight = 0;
+      while (sizeRight < width && right != last)
+      {
+        ++right;
+        sizeRight++;
+      }
+      numScanned += sizeRight;
+
+      // merge both runs, output never overtakes the right run
+      auto scratchEnd = std::move(left, mid, scratch);
+      auto output = left;
+      auto scan   = mid;
+      for (auto current = scratch; current != scratchEnd; ++output)
+      {
+        // prefer left element if equal (=> stable)
+        if (scan != right && lessThan(*scan, *current))
+          *output = std::move(*scan++);
+        else
+          *output = std::move(*current++);
+      }
+      // remaining elements of the right run are already in place
+
+      // whole range merged ?
+      if (left == first && right == last)
+        return;
+
+      left = right;
+    }
+
+    numElements = numScanned;
   }
+}
 
-  // move pivot to its final position
-  if (pivot != left && lessThan(*pivot, *left))
-    std::iter_swap(pivot, left);
 
-  // subdivide
-  quickSort(first,  left, lessThan);
-  quickSort(++left, last, lessThan); // *left itself is already sorted
+/// bottom-up Merge Sort for forward iterators with caller-provided scratch memory (as many elements as the input)
+template <typename iterator, typename LessThan>
+void mergeSortBottomUp(iterator first, iterator last, LessThan lessThan,
+                       typename std::iterator_traits<iterator>::value_type* scratch, std::forward_iterator_tag)
+{
+  mergeSortBottomUpForward(first, last, lessThan, [scratch](size_t) { return scratch; });
 }
 
 
-/// Quick Sort with default less-than operator
-template <typename iterator>
-void quickSort(iterator first, iterator last)
+/// bottom-up Merge Sort (no recursion) with caller-provided scratch memory (at least as many elements as the input),
+/// allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+void mergeSortBottomUp(iterator first, iterator last, LessThan lessThan, typename std::iterator_traits<iterator>::value_type* scratch)
 {
-  quickSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+  mergeSortBottomUp(first, last, lessThan, scratch, typename std::iterator_traits<iterator>::iterator_category());
 }
 
 
-// /////////////////////////////////////////////////////////////////////
+/// bottom-up Merge Sort for random-access iterators, "getScratch(size)" returns memory for at least "size" elements
+template <typename iterator, typename LessThan, typename GetScratch>
+void mergeSortBottomUpGetScratch(iterator first, iterator last, LessThan lessThan, GetScratch getScratch,
+                                 std::random_access_iterator_tag)
+{
+  // small inputs are handled by Insertion Sort
+  size_t numElements = last - first;
+  mergeSortBottomUp(first, last, lessThan, getScratch(numElements <= MergeSortBottomUpBlockSize ? 0 : numElements),
+                    std::random_access_iterator_tag());
+}
+
+/// bottom-up Merge Sort for forward iterators, the scratch memory grows with the width of the runs (no std::distance)
+template <typename iterator, typename LessThan, typename GetScratch>
+void mergeSortBottomUpGetScratch(iterator first, iterator last, LessThan lessThan, GetScratch getScratch,
+                                 std::forward_iterator_tag)
+{
+  mergeSortBottomUpForward(first, last, lessThan, getScratch);
+}
 
 
-/// Intro Sort, allow user-defined less-than operator
+/// bottom-up Merge Sort (no recursion), allow user-defined less-than operator (requires additional memory)
 template <typename iterator, typename LessThan>
-void introSort(iterator first, iterator last, LessThan lessThan)
+void mergeSortBottomUp(iterator first, iterator last, LessThan lessThan)
 {
-  // switch to Insertion Sort if the (sub)array is small
-  auto numElements = std::distance(first, last);
-  if (numElements <= 16)
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  ScratchBuffer<Value> scratch(0, first);
+  auto getScratch = [&](size_t size) -> Value*
   {
-    // already sorted ?
-    if (numElements <= 1)
-      return;
+    if (scratch.size() < size)
+      scratch.reset(size, first);
+    return scratch.data();
+  };
+  mergeSortBottomUpGetScratch(first, last, lessThan, getScratch, typename std::iterator_traits<iterator>::iterator_category());
+}
 
-    // micro-optimization for exactly 2 elements
-    if (numElements == 2)
+
+/// bottom-up Merge Sort without any heap allocations: falls back to (recursive) Merge Sort with in-place merging, still stable
+template <typename iterator, typename LessThan>
+void mergeSortBottomUp(iterator first, iterator last, LessThan lessThan, NoAlloc)
+{
+  mergeSort(first, last, lessThan, NoAlloc());
+}
+
+
+#if __cplusplus >= 201703L
+/// bottom-up Merge Sort, scratch memory is taken from a user-defined memory resource
+template <typename iterator, typename LessThan>
+void mergeSortBottomUp(iterator first, iterator last, LessThan lessThan, std::pmr::memory_resource* resource)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  std::pmr::vector<Value> scratch(resource);
+  auto getScratch = [&](size_t size) -> Value*
+  {
+    if (scratch.size() < size)
     {
-      if (lessThan(*(first + 1), *first))
-        std::iter_swap(first + 1, first);
-      return;
+      scratch.clear();
+      scratch.resize(size);
     }
+    return scratch.data();
+  };
+  mergeSortBottomUpGetScratch(first, last, lessThan, getScratch, typename std::iterator_traits<iterator>::iterator_category());
+}
+#endif
+
+
+/// bottom-up Merge Sort (no recursion) with default less-than operator (requires additional memory)
+template <typename iterator>
+void mergeSortBottomUp(iterator first, iterator last)
+{
+  mergeSortBottomUp(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
 
-    // between 3 and 16 elements
-    insertionSort(first, last, lessThan);
+
+// /////////////////////////////////////////////////////////////////////
+// few comparisons: for expensive less-than operators
+
+
+/// Ford-Johnson's merge insertion: sort positions "items" of elements in [first, ...) with about log2(n!) comparisons
+/// "partner" maps each position to the smaller element of its pair (shared by all levels of recursion)
+template <typename iterator, typename LessThan>
+void mergeInsertion(iterator first, std::vector<size_t>& items, std::vector<size_t>& partner, LessThan lessThan)
+{
+  size_t numItems = items.size();
+  if (numItems <= 1)
     return;
+
+  // compare pairs: larger element at even, smaller at odd positions
+  size_t numPairs = numItems / 2;
+  std::vector<size_t> larger(numPairs);
+  for (size_t i = 0; i < numPairs; i++)
+  {
+    if (lessThan(first[items[2*i]], first[items[2*i + 1]]))
+      std::swap(items[2*i], items[2*i + 1]);
+    larger[i] = items[2*i];
   }
 
-  auto pivot = last;
-  --pivot;
+  // sort larger elements recursively
+  mergeInsertion(first, larger, partner, lessThan);
+  // deeper levels overwrote some partners
+  for (size_t i = 0; i < numPairs; i++)
+    partner[items[2*i]] = items[2*i + 1];
 
-  // choose middle element as pivot (good choice for partially sorted data)
-  auto middle = first;
-  std::advance(middle, numElements/2);
-  std::iter_swap(middle, pivot);
+  // main chain: partner of the smallest larger element, then all larger elements
+  std::vector<size_t> chain;
+  chain.reserve(numItems);
+  chain.push_back(partner[larger[0]]);
+  chain.insert(chain.end(), larger.begin(), larger.end());
 
-  // scan beginning from left and right end and swap misplaced elements
-  auto left  = first;
-  auto right = pivot;
-  while (left != right)
+  // insert the other smaller elements (and the unpaired element) in groups whose sizes follow the Jacobsthal numbers,
+  // each group in reverse order => every binary search covers 2^k - 1 elements
+  auto compare = [&](size_t a, size_t b) { return lessThan(first[a], first[b]); };
+  size_t numPending = numPairs + numItems % 2;
+  size_t groupFirst = 1; // b1 is already in the chain
+  size_t groupLast  = 3;
+  while (groupFirst < numPending)
   {
-    // look for mismatches
-    while (!lessThan(*pivot, *left)  && left != right)
-      ++left;
-    while (!lessThan(*right, *pivot) && left != right)
-      --right;
-    // swap two values which are both on the wrong side of the pivot element
-    if (left != right)
-      std::iter_swap(left, right);
+    for (size_t k = std::min(groupLast, numPending); k > groupFirst; k--)
+    {
+      // b_k is smaller than its partner a_k, the unpaired element has no upper bound
+      bool   paired = k <= numPairs;
+      size_t insert = paired ? partner[larger[k - 1]] : items.back();
+      auto   bound  = paired ? std::find(chain.begin(), chain.end(), larger[k - 1]) : chain.end();
+      chain.insert(std::upper_bound(chain.begin(), bound, insert, compare), insert);
+    }
+
+    size_t next = groupLast + 2 * groupFirst;
+    groupFirst  = groupLast;
+    groupLast   = next;
   }
 
-  // move pivot to its final position
-  if (pivot != left && lessThan(*pivot, *left))
-    std::iter_swap(pivot, left);
+  items.swap(chain);
+}
+
+
+/// Ford-Johnson's merge insertion: close to the minimum number of comparisons but O(n^2) moves of indices (requires additional memory)
+/// => only for small ranges or extremely expensive comparisons
+template <typename iterator, typename LessThan>
+void mergeInsertionSort(iterator first, iterator last, LessThan lessThan)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+
+  size_t numElements = last - first;
+  if (numElements <= 1)
+    return;
 
-  // subdivide
-  introSort(first,  left, lessThan);
-  introSort(++left, last, lessThan); // *left itself is already sorted
+  // sort positions
+  std::vector<size_t> items(numElements), partner(numElements);
+  for (size_t i = 0; i < numElements; i++)
+    items[i] = i;
+  mergeInsertion(first, items, partner, lessThan);
+
+  // move each element exactly twice
+  std::vector<Value> sorted;
+  sorted.reserve(numElements);
+  for (auto item : items)
+    sorted.push_back(std::move(first[item]));
+  std::move(sorted.begin(), sorted.end(), first);
 }
 
 
-/// Intro Sort with default less-than operator
+/// Ford-Johnson's merge insertion with default less-than operator (requires additional memory)
 template <typename iterator>
-void introSort(iterator first, iterator last)
+void mergeInsertionSort(iterator first, iterator last)
 {
-  introSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+  mergeInsertionSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// Merge Sort with merge insertion for small ranges, "scratch" holds at least half as many elements as the input
+template <typename iterator, typename LessThan>
+void mergeSortMinComparisons(iterator first, iterator last, LessThan lessThan,
+                             typename std::iterator_traits<iterator>::value_type* scratch)
+{
+  const size_t MergeInsertionCutoff = 64;
+
+  size_t numElements = last - first;
+  if (numElements <= MergeInsertionCutoff)
+  {
+    mergeInsertionSort(first, last, lessThan);
+    return;
+  }
+
+  auto mid = first + numElements / 2;
+  mergeSortMinComparisons(first, mid,  lessThan, scratch);
+  mergeSortMinComparisons(mid,   last, lessThan, scratch);
+  mergeWithBuffer(first, mid, last, scratch, lessThan);
+}
+
+
+/// Merge Sort with merge insertion for small ranges: close to log2(n!) comparisons, for expensive less-than operators
+/// (random-access iterators only, requires additional memory)
+template <typename iterator, typename LessThan>
+void mergeSortMinComparisons(iterator first, iterator last, LessThan lessThan)
+{
+  ScratchBuffer<typename std::iterator_traits<iterator>::value_type> scratch((last - first) / 2, first);
+  mergeSortMinComparisons(first, last, lessThan, scratch.data());
+}
+
+
+/// Merge Sort with merge insertion for small ranges without any heap allocations: falls back to Merge Sort with in-place merging
+/// (merge insertion keeps its own index arrays)
+template <typename iterator, typename LessThan>
+void mergeSortMinComparisons(iterator first, iterator last, LessThan lessThan, NoAlloc)
+{
+  mergeSort(first, last, lessThan, NoAlloc());
+}
+
+
+/// Merge Sort with merge insertion for small ranges and default less-than operator (requires additional memory)
+template <typename iterator>
+void mergeSortMinComparisons(iterator first, iterator last)
+{
+  mergeSortMinComparisons(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// merge sorted list "from" into sorted list "to" by relinking nodes, "from" will be empty
+/// elements of "to" come first if equal (=> stable)
+template <typename T, typename Allocator, typename LessThan>
+void listMerge(std::list<T, Allocator>& to, std::list<T, Allocator>& from, LessThan lessThan)
+{
+  auto insertBefore = to.begin();
+  auto current      = from.begin();
+  while (insertBefore != to.end() && current != from.end())
+  {
+    if (lessThan(*current, *insertBefore))
+    {
+      auto next = current;
+      ++next;
+      to.splice(insertBefore, from, current);
+      current = next;
+    }
+    else
+      ++insertBefore;
+  }
+
+  // append all remaining elements
+  to.splice(to.end(), from);
+}
+
+
+/// bottom-up Merge Sort for std::list, allow user-defined less-than operator
+/// only nodes are relinked, values are never copied or moved (stable)
+template <typename T, typename Allocator, typename LessThan>
+void listMergeSort(std::list<T, Allocator>& data, LessThan lessThan)
+{
+  // empty or just one element ?
+  if (data.empty() || ++data.begin() == data.end())
+    return;
+
+  // bins[i] is either empty or holds a sorted list of 2^i elements,
+  // higher bins always contain elements which were in front of lower bins
+  const size_t MaxBins = 64;
+  std::list<T, Allocator> bins[MaxBins];
+  std::list<T, Allocator> carry;
+  size_t numBins = 0;
+  while (!data.empty())
+  {
+    // take next element
+    carry.splice(carry.begin(), data, data.begin());
+
+    // merge with all non-empty bins, like incrementing a binary counter
+    size_t bin = 0;
+    for (; bin < numBins && !bins[bin].empty(); bin++)
+    {
+      listMerge(bins[bin], carry, lessThan);
+      carry.swap(bins[bin]);
+    }
+    carry.swap(bins[bin]);
+    if (bin == numBins)
+      numBins++;
+  }
+
+  // merge all bins, beginning with the smallest
+  for (size_t bin = 1; bin < numBins; bin++)
+    listMerge(bins[bin], bins[bin - 1], lessThan);
+  data.swap(bins[numBins - 1]);
+}
+
+
+/// bottom-up Merge Sort for std::list with default less-than operator
+template <typename T, typename Allocator>
+void listMergeSort(std::list<T, Allocator>& data)
+{
+  listMergeSort(data, std::less<T>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// sort three elements in-place, return the median (which is now stored in "b")
+/// note: just looking at the median instead of moving elements leads to
+///       very unbalanced partitions for partially sorted data
+template <typename iterator, typename LessThan>
+iterator sortMedianOf3(iterator a, iterator b, iterator c, LessThan lessThan, std::false_type)
+{
+  if (lessThan(*b, *a))
+    std::iter_swap(b, a);
+  if (lessThan(*c, *b))
+  {
+    std::iter_swap(c, b);
+    if (lessThan(*b, *a))
+      std::iter_swap(b, a);
+  }
+  return b;
+}
+
+/// sort three elements in-place without branches (cheap comparisons only), return the median (which is now stored in "b")
+template <typename iterator, typename LessThan>
+iterator sortMedianOf3(iterator a, iterator b, iterator c, LessThan lessThan, std::true_type)
+{
+  conditionalSwap(*a, *b, lessThan);
+  conditionalSwap(*b, *c, lessThan);
+  conditionalSwap(*a, *b, lessThan);
+  return b;
+}
+
+/// sort three elements in-place, return the median (which is now stored in "b")
+template <typename iterator, typename LessThan>
+iterator sortMedianOf3(iterator a, iterator b, iterator c, LessThan lessThan)
+{
+  return sortMedianOf3(a, b, c, lessThan,
+                       IsCheapComparison<typename std::iterator_traits<iterator>::value_type, LessThan>());
+}
+
+
+/// pivot: middle element (good choice for partially sorted data)
+struct PivotMiddle
+{
+  template <typename iterator, typename LessThan>
+  static iterator select(iterator first, iterator /*last*/, size_t numElements, LessThan /*lessThan*/)
+  {
+    std::advance(first, numElements/2);
+    return first;
+  }
+};
+
+
+/// pivot: median of the elements at 1/4, 1/2 and 3/4 of the range
+/// note: the first and last element are avoided because partitioning often leaves
+///       the smallest/largest element there which would lead to very unbalanced partitions
+struct PivotMedianOf3
+{
+  template <typename iterator, typename LessThan>
+  static iterator select(iterator first, iterator /*last*/, size_t numElements, LessThan lessThan)
+  {
+    if (numElements < 3)
+      return first;
+
+    auto step = numElements / 4;
+    auto left = first;
+    std::advance(left, step);
+    auto middle = left;
+    std::advance(middle, numElements/2 - step);
+    auto right = middle;
+    std::advance(right, step);
+    // "right" must differ from "middle" (only relevant for 3 elements)
+    if (step == 0)
+      ++right;
+    return sortMedianOf3(left, middle, right, lessThan);
+  }
+};
+
+
+/// pivot: Tukey's ninther, median of three medians of three elements (evenly spaced)
+struct PivotNinther
+{
+  template <typename iterator, typename LessThan>
+  static iterator select(iterator first, iterator last, size_t numElements, LessThan lessThan)
+  {
+    if (numElements < 9)
+      return PivotMedianOf3::select(first, last, numElements, lessThan);
+
+    // walk once through the range and pick nine elements
+    auto step = (numElements - 1) / 8;
+    iterator samples[9];
+    samples[0] = first;
+    for (int i = 1; i < 9; i++)
+    {
+      samples[i] = samples[i - 1];
+      std::advance(samples[i], step);
+    }
+
+    return sortMedianOf3(sortMedianOf3(samples[0], samples[1], samples[2], lessThan),
+                         sortMedianOf3(samples[3], samples[4], samples[5], lessThan),
+                         sortMedianOf3(samples[6], samples[7], samples[8], lessThan), lessThan);
+  }
+};
+
+
+/// pivot: median of a random sample (about log2(n) elements)
+struct PivotRandomSample
+{
+  /// simple xorshift random number generator
+  static uint32_t random()
+  {
+    static thread_local uint32_t state = 2463534242U;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state <<  5;
+    return state;
+  }
+
+  template <typename iterator, typename LessThan>
+  static iterator select(iterator first, iterator last, size_t numElements, LessThan lessThan)
+  {
+    // odd number of samples, between 3 and 31
+    const size_t MaxSamples = 31;
+    size_t numSamples = 1;
+    while ((size_t(1) << numSamples) < numElements && numSamples < MaxSamples)
+      numSamples++;
+    numSamples |= 1;
+    if (numSamples < 3 || numElements < 2 * numSamples)
+      return PivotMedianOf3::select(first, last, numElements, lessThan);
+
+    // random positions in ascending order (insertion sort)
+    size_t positions[MaxSamples];
+    for (size_t i = 0; i < numSamples; i++)
+    {
+      auto position = size_t(random() % numElements);
+      auto j = i;
+      for (; j > 0 && positions[j - 1] > position; j--)
+        positions[j] = positions[j - 1];
+      positions[j] = position;
+    }
+
+    // walk once through the range
+    iterator samples[MaxSamples];
+    size_t current = 0;
+    for (size_t i = 0; i < numSamples; i++)
+    {
+      std::advance(first, positions[i] - current);
+      current = positions[i];
+      samples[i] = first;
+    }
+
+    // sort sampled iterators by their values (insertion sort), return median
+    for (size_t i = 1; i < numSamples; i++)
+    {
+      auto compare = samples[i];
+      auto j = i;
+      for (; j > 0 && lessThan(*compare, *samples[j - 1]); j--)
+        samples[j] = samples[j - 1];
+      samples[j] = compare;
+    }
+    return samples[numSamples / 2];
+  }
+};
+
+
+/// pivot: choose strategy depending on size
+struct PivotAdaptive
+{
+  template <typename iterator, typename LessThan>
+  static iterator select(iterator first, iterator last, size_t numElements, LessThan lessThan)
+  {
+    if (numElements < 512)
+      return PivotMedianOf3::select(first, last, numElements, lessThan);
+    return   PivotNinther  ::select(first, last, numElements, lessThan);
+  }
+};
+
+
+
+/// true if block partitioning should be used (random-access iterators and cheap comparisons)
+template <typename iterator, typename LessThan>
+struct UseBlockPartition : std::integral_constant<bool,
+                             std::is_same<typename std::iterator_traits<iterator>::iterator_category,
+                                          std::random_access_iterator_tag>::value &&
+                             IsCheapComparison<typename std::iterator_traits<iterator>::value_type, LessThan>::value> {};
+
+
+/// Hoare-style partitioning of [first,pivot) where pivot is the last element
+/// return final position of pivot and store number of elements in front of it in "numLeft"
+template <typename iterator, typename LessThan>
+iterator partitionScan(iterator first, iterator pivot, LessThan lessThan, size_t& numLeft, std::false_type)
+{
+  // scan beginning from left and right end and swap misplaced elements
+  auto left  = first;
+  auto right = pivot;
+  numLeft = 0;
+  while (left != right)
+  {
+    // look for mismatches
+    while (!lessThan(*pivot, *left)  && left != right)
+    {
+      ++left;
+      ++numLeft;
+    }
+    while (!lessThan(*right, *pivot) && left != right)
+      --right;
+    // swap two values which are both on the wrong side of the pivot element
+    if (left != right)
+      std::iter_swap(left, right);
+  }
+
+  // move pivot to its final position
+  if (pivot != left && lessThan(*pivot, *left))
+    std::iter_swap(pivot, left);
+
+  return left;
+}
+
+
+/// block partitioning of [first,pivot) where pivot is the last element (BlockQuicksort by Edelkamp and Weiss)
+/// comparison results are stored without branches in offset buffers, then misplaced elements are swapped in bulk
+/// return final position of pivot and store number of elements in front of it in "numLeft"
+template <typename iterator, typename LessThan>
+iterator partitionScan(iterator first, iterator pivot, LessThan lessThan, size_t& numLeft, std::true_type)
+{
+  const size_t BlockSize = 64;
+
+  auto pivotValue = *pivot;
+  // [first,left) < pivot, [right,pivot) >= pivot
+  auto left  = first;
+  auto right = pivot;
+
+  // offsets of misplaced elements relative to left and right (right counts backwards)
+  unsigned char offsetsLeft [BlockSize];
+  unsigned char offsetsRight[BlockSize];
+  size_t startLeft  = 0, numMisplacedLeft  = 0;
+  size_t startRight = 0, numMisplacedRight = 0;
+
+  while (size_t(right - left) > 2 * BlockSize)
+  {
+    // find elements >= pivot in the left block
+    if (numMisplacedLeft == 0)
+    {
+      startLeft = 0;
+      for (size_t i = 0; i < BlockSize; i++)
+      {
+        offsetsLeft[numMisplacedLeft] = (unsigned char)i;
+        numMisplacedLeft += !lessThan(*(left + i), pivotValue);
+      }
+    }
+
+    // find elements < pivot in the right block
+    if (numMisplacedRight == 0)
+    {
+      startRight = 0;
+      for (size_t i = 0; i < BlockSize; i++)
+      {
+        offsetsRight[numMisplacedRight] = (unsigned char)i;
+        numMisplacedRight += lessThan(*(right - 1 - i), pivotValue);
+      }
+    }
+
+    // swap pairs of misplaced elements
+    size_t numSwaps = numMisplacedLeft < numMisplacedRight ? numMisplacedLeft : numMisplacedRight;
+    for (size_t i = 0; i < numSwaps; i++)
+      std::iter_swap(left + offsetsLeft[startLeft + i], right - 1 - offsetsRight[startRight + i]);
+    numMisplacedLeft  -= numSwaps;
+    numMisplacedRight -= numSwaps;
+    startLeft  += numSwaps;
+    startRight += numSwaps;
+
+    // blocks without misplaced elements are finished
+    if (numMisplacedLeft == 0)
+      left  += BlockSize;
+    if (numMisplacedRight == 0)
+      right -= BlockSize;
+  }
+
+  // partition remaining elements (including unfinished blocks) the classic way
+  while (true)
+  {
+    while (left < right && lessThan(*left, pivotValue))
+      ++left;
+    while (left < right && !lessThan(*(right - 1), pivotValue))
+      --right;
+    if (!(left < right))
+      break;
+    std::iter_swap(left++, --right);
+  }
+
+  // move pivot to its final position
+  std::iter_swap(pivot, left);
+  numLeft = left - first;
+  return left;
+}
+
+
+/// partition "numElements" (at least two) elements around a pivot chosen by PivotPolicy
+/// return final position of that pivot and store number of elements in front of it in "numLeft"
+template <typename PivotPolicy, typename iterator, typename LessThan>
+iterator quickSortPartition(iterator first, iterator last, LessThan lessThan, size_t numElements, size_t& numLeft,
+                            std::bidirectional_iterator_tag)
+{
+  auto pivot = last;
+  --pivot;
+
+  // move pivot to the end
+  auto chosen = PivotPolicy::select(first, last, numElements, lessThan);
+  if (chosen != pivot)
+    std::iter_swap(chosen, pivot);
+
+  // cheap comparisons: branch-free block partitioning, else Hoare-style partitioning
+  return partitionScan(first, pivot, lessThan, numLeft, UseBlockPartition<iterator, LessThan>());
+}
+
+
+/// Lomuto partitioning for forward iterators: the pivot is moved to the front, smaller elements are collected behind it
+/// return final position of that pivot and store number of elements in front of it in "numLeft"
+template <typename PivotPolicy, typename iterator, typename LessThan>
+iterator quickSortPartition(iterator first, iterator last, LessThan lessThan, size_t numElements, size_t& numLeft,
+                            std::forward_iterator_tag)
+{
+  // move pivot to the front
+  auto chosen = PivotPolicy::select(first, last, numElements, lessThan);
+  if (chosen != first)
+    std::iter_swap(chosen, first);
+
+  // [first+1,store] < pivot
+  auto store = first;
+  numLeft = 0;
+  auto scan = first;
+  for (++scan; scan != last; ++scan)
+    if (lessThan(*scan, *first))
+    {
+      ++store;
+      ++numLeft;
+      if (store != scan)
+        std::iter_swap(store, scan);
+    }
+
+  // move pivot to its final position
+  if (store != first)
+    std::iter_swap(first, store);
+  return store;
+}
+
+
+/// partition "numElements" (at least two) elements around a pivot chosen by PivotPolicy
+/// return final position of that pivot and store number of elements in front of it in "numLeft"
+template <typename PivotPolicy, typename iterator, typename LessThan>
+iterator quickSortPartition(iterator first, iterator last, LessThan lessThan, size_t numElements, size_t& numLeft)
+{
+  return quickSortPartition<PivotPolicy>(first, last, lessThan, numElements, numLeft,
+                                         typename std::iterator_traits<iterator>::iterator_category());
+}
+
+
+/// Quick Sort, allow user-defined less-than operator and pivot selection (PivotMiddle, PivotMedianOf3, ...)
+template <typename PivotPolicy, typename iterator, typename LessThan>
+void quickSort(iterator first, iterator last, LessThan lessThan, size_t size = 0)
+{
+  // determine size if not known yet
+  if (size == 0 && first != last)
+    size = std::distance(first, last);
+  // by the way, the size parameter can be omitted but
+  // then we are required to compute it each time which can be expensive
+  // for non-random access iterators
+
+  auto numElements = size;
+  // already sorted ?
+  if (numElements <= 1)
+    return;
+
+  // partition
+  size_t numLeft;
+  auto left = quickSortPartition<PivotPolicy>(first, last, lessThan, numElements, numLeft);
+
+  // subdivide, pass sizes to avoid std::distance for non-random access iterators
+  quickSort<PivotPolicy>(first,  left, lessThan, numLeft);
+  quickSort<PivotPolicy>(++left, last, lessThan, numElements - numLeft - 1); // *left itself is already sorted
+}
+
+
+/// Quick Sort, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+void quickSort(iterator first, iterator last, LessThan lessThan, size_t size = 0)
+{
+  quickSort<PivotAdaptive>(first, last, lessThan, size);
+}
+
+
+/// Quick Sort with default less-than operator and user-defined pivot selection
+template <typename PivotPolicy, typename iterator>
+void quickSort(iterator first, iterator last)
+{
+  quickSort<PivotPolicy>(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// Quick Sort with default less-than operator
+template <typename iterator>
+void quickSort(iterator first, iterator last)
+{
+  quickSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// iterative Quick Sort, allow user-defined less-than operator
+/// uses a small fixed-size stack instead of recursion: the larger partition is postponed
+/// while the smaller is processed immediately, therefore at most log2(n) partitions are pending
+/// many duplicates: if a pivot equals one of the pivots enclosing its partition then all elements equal to it are skipped at once
+template <typename iterator, typename LessThan>
+void quickSortIterative(iterator first, iterator last, LessThan lessThan)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+
+  // pending partitions, the pivots in front of ("lower") and behind ("upper") a partition are its bounds
+  struct Range
+  {
+    iterator first;
+    iterator last;
+    size_t   size;
+    iterator lower;
+    iterator upper;
+    bool     hasLower;
+    bool     hasUpper;
+  };
+  Range  stack[8 * sizeof(size_t)];
+  size_t stackSize = 0;
+
+  size_t numElements = std::distance(first, last);
+  auto   lower    = first;
+  auto   upper    = first;
+  bool   hasLower = false;
+  bool   hasUpper = false;
+  while (true)
+  {
+    while (numElements > 1)
+    {
+      size_t numLeft;
+      auto pivot = quickSortPartition<PivotAdaptive>(first, last, lessThan, numElements, numLeft);
+      size_t numRight = numElements - numLeft - 1;
+      auto afterPivot = pivot;
+      ++afterPivot;
+
+      // pivot equal to the lower bound ? => the left partition contains only elements equal to the pivot,
+      // move all elements equal to the pivot to the front of the right partition and skip them, too
+      if (hasLower && !lessThan(*lower, *pivot))
+      {
+        auto larger = std::partition(afterPivot, last, [&](const Value& x) { return !lessThan(*pivot, x); });
+        numElements = numRight - std::distance(afterPivot, larger);
+        first       = larger;
+        lower       = pivot;
+        continue;
+      }
+      // pivot equal to the upper bound ? => same for the right partition
+      if (hasUpper && !lessThan(*pivot, *upper))
+      {
+        auto equal  = std::partition(first, pivot, [&](const Value& x) { return lessThan(x, *pivot); });
+        numElements = std::distance(first, equal);
+        last        = equal;
+        upper       = pivot;
+        continue;
+      }
+
+      // postpone larger partition, continue with smaller partition
+      if (numLeft > numRight)
+      {
+        Range larger = { first, pivot, numLeft, lower, pivot, hasLower, true };
+        stack[stackSize++] = larger;
+        first       = afterPivot;
+        numElements = numRight;
+        lower       = pivot;
+        hasLower    = true;
+      }
+      else
+      {
+        Range larger = { afterPivot, last, numRight, pivot, upper, true, hasUpper };
+        stack[stackSize++] = larger;
+        last        = pivot;
+        numElements = numLeft;
+        upper       = pivot;
+        hasUpper    = true;
+      }
+    }
+
+    // all done ?
+    if (stackSize == 0)
+      return;
+
+    // process postponed partition
+    --stackSize;
+    first       = stack[stackSize].first;
+    last        = stack[stackSize].last;
+    numElements = stack[stackSize].size;
+    lower       = stack[stackSize].lower;
+    upper       = stack[stackSize].upper;
+    hasLower    = stack[stackSize].hasLower;
+    hasUpper    = stack[stackSize].hasUpper;
+  }
+}
+
+
+/// iterative Quick Sort with default less-than operator
+template <typename iterator>
+void quickSortIterative(iterator first, iterator last)
+{
+  quickSortIterative(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// Intro Sort, allow user-defined less-than operator, pivot selection and Insertion Sort threshold
+template <typename PivotPolicy, typename iterator, typename LessThan>
+void introSort(iterator first, iterator last, LessThan lessThan, size_t insertionSortCutoff, size_t size = 0)
+{
+  // determine size if not known yet (expensive for non-random access iterators)
+  if (size == 0 && first != last)
+    size = std::distance(first, last);
+
+  // switch to Insertion Sort if the (sub)array is small
+  auto numElements = size;
+  if (numElements <= insertionSortCutoff || numElements <= 1)
+  {
+    // already sorted ?
+    if (numElements <= 1)
+      return;
+
+    // micro-optimization for exactly 2 elements
+    if (numElements == 2)
+    {
+      auto second = first;
+      ++second;
+      conditionalSwap(*first, *second, lessThan);
+      return;
+    }
+
+    // between 3 and insertionSortCutoff elements
+    insertionSortByCost(first, last, lessThan, IsCheapComparison<typename std::iterator_traits<iterator>::value_type, LessThan>());
+    return;
+  }
+
+  // partition
+  size_t numLeft;
+  auto left = quickSortPartition<PivotPolicy>(first, last, lessThan, numElements, numLeft);
+
+  // subdivide, pass sizes to avoid std::distance for non-random access iterators
+  introSort<PivotPolicy>(first,  left, lessThan, insertionSortCutoff, numLeft);
+  introSort<PivotPolicy>(++left, last, lessThan, insertionSortCutoff, numElements - numLeft - 1); // *left itself is already sorted
+}
+
+
+/// Intro Sort, allow user-defined less-than operator and Insertion Sort threshold
+template <typename iterator, typename LessThan>
+void introSort(iterator first, iterator last, LessThan lessThan, size_t insertionSortCutoff, size_t size = 0)
+{
+  introSort<PivotAdaptive>(first, last, lessThan, insertionSortCutoff, size);
+}
+
+
+/// Intro Sort, allow user-defined less-than operator and pivot selection
+template <typename PivotPolicy, typename iterator, typename LessThan>
+void introSort(iterator first, iterator last, LessThan lessThan)
+{
+  introSort<PivotPolicy>(first, last, lessThan, SortTuningIntroSortCutoff);
+}
+
+
+/// Intro Sort with default less-than operator and user-defined pivot selection
+template <typename PivotPolicy, typename iterator>
+void introSort(iterator first, iterator last)
+{
+  introSort<PivotPolicy>(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// Intro Sort, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+void introSort(iterator first, iterator last, LessThan lessThan)
+{
+  introSort(first, last, lessThan, SortTuningIntroSortCutoff);
+}
+
+
+/// Intro Sort with default less-than operator
+template <typename iterator>
+void introSort(iterator first, iterator last)
+{
+  introSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// Bose-Nelson sorting network: merge the sorted ranges [I,I+X) and [J,J+Y)
+template <size_t I, size_t X, size_t J, size_t Y>
+struct BoseNelsonMerge
+{
+  template <typename iterator, typename LessThan>
+  static void run(iterator data, LessThan lessThan)
+  {
+    const size_t A = X / 2;
+    const size_t B = (X & 1) ? Y / 2 : (Y + 1) / 2;
+    BoseNelsonMerge<I,     A,     J,     B    >::run(data, lessThan);
+    BoseNelsonMerge<I + A, X - A, J + B, Y - B>::run(data, lessThan);
+    BoseNelsonMerge<I + A, X - A, J,     B    >::run(data, lessThan);
+  }
+};
+
+template <size_t I, size_t J>
+struct BoseNelsonMerge<I, 1, J, 1>
+{
+  template <typename iterator, typename LessThan>
+  static void run(iterator data, LessThan lessThan)
+  {
+    conditionalSwap(*(data + I), *(data + J), lessThan);
+  }
+};
+
+template <size_t I, size_t J>
+struct BoseNelsonMerge<I, 1, J, 2>
+{
+  template <typename iterator, typename LessThan>
+  static void run(iterator data, LessThan lessThan)
+  {
+    conditionalSwap(*(data + I), *(data + J + 1), lessThan);
+    conditionalSwap(*(data + I), *(data + J),     lessThan);
+  }
+};
+
+template <size_t I, size_t J>
+struct BoseNelsonMerge<I, 2, J, 1>
+{
+  template <typename iterator, typename LessThan>
+  static void run(iterator data, LessThan lessThan)
+  {
+    conditionalSwap(*(data + I),     *(data + J), lessThan);
+    conditionalSwap(*(data + I + 1), *(data + J), lessThan);
+  }
+};
+
+
+/// Bose-Nelson sorting network: sort the M elements starting at I, fully unrolled at compile-time
+template <size_t I, size_t M>
+struct BoseNelsonSort
+{
+  template <typename iterator, typename LessThan>
+  static void run(iterator data, LessThan lessThan)
+  {
+    const size_t A = M / 2;
+    BoseNelsonSort <I,     A    >::run(data, lessThan);
+    BoseNelsonSort <I + A, M - A>::run(data, lessThan);
+    BoseNelsonMerge<I, A, I + A, M - A>::run(data, lessThan);
+  }
+};
+
+/// a single element is always sorted
+template <size_t I>
+struct BoseNelsonSort<I, 1>
+{
+  template <typename iterator, typename LessThan>
+  static void run(iterator, LessThan) {}
+};
+
+
+/// sort up to 32 elements with a sorting network (jump table), larger ranges are handled by Insertion Sort
+template <typename iterator, typename LessThan>
+void smallSortNetwork(iterator first, size_t numElements, LessThan lessThan)
+{
+  switch (numElements)
+  {
+  case  0:
+  case  1: return;
+  case  2: BoseNelsonSort<0,  2>::run(first, lessThan); return;
+  case  3: BoseNelsonSort<0,  3>::run(first, lessThan); return;
+  case  4: BoseNelsonSort<0,  4>::run(first, lessThan); return;
+  case  5: BoseNelsonSort<0,  5>::run(first, lessThan); return;
+  case  6: BoseNelsonSort<0,  6>::run(first, lessThan); return;
+  case  7: BoseNelsonSort<0,  7>::run(first, lessThan); return;
+  case  8: BoseNelsonSort<0,  8>::run(first, lessThan); return;
+  case  9: BoseNelsonSort<0,  9>::run(first, lessThan); return;
+  case 10: BoseNelsonSort<0, 10>::run(first, lessThan); return;
+  case 11: BoseNelsonSort<0, 11>::run(first, lessThan); return;
+  case 12: BoseNelsonSort<0, 12>::run(first, lessThan); return;
+  case 13: BoseNelsonSort<0, 13>::run(first, lessThan); return;
+  case 14: BoseNelsonSort<0, 14>::run(first, lessThan); return;
+  case 15: BoseNelsonSort<0, 15>::run(first, lessThan); return;
+  case 16: BoseNelsonSort<0, 16>::run(first, lessThan); return;
+  case 17: BoseNelsonSort<0, 17>::run(first, lessThan); return;
+  case 18: BoseNelsonSort<0, 18>::run(first, lessThan); return;
+  case 19: BoseNelsonSort<0, 19>::run(first, lessThan); return;
+  case 20: BoseNelsonSort<0, 20>::run(first, lessThan); return;
+  case 21: BoseNelsonSort<0, 21>::run(first, lessThan); return;
+  case 22: BoseNelsonSort<0, 22>::run(first, lessThan); return;
+  case 23: BoseNelsonSort<0, 23>::run(first, lessThan); return;
+  case 24: BoseNelsonSort<0, 24>::run(first, lessThan); return;
+  case 25: BoseNelsonSort<0, 25>::run(first, lessThan); return;
+  case 26: BoseNelsonSort<0, 26>::run(first, lessThan); return;
+  case 27: BoseNelsonSort<0, 27>::run(first, lessThan); return;
+  case 28: BoseNelsonSort<0, 28>::run(first, lessThan); return;
+  case 29: BoseNelsonSort<0, 29>::run(first, lessThan); return;
+  case 30: BoseNelsonSort<0, 30>::run(first, lessThan); return;
+  case 31: BoseNelsonSort<0, 31>::run(first, lessThan); return;
+  case 32: BoseNelsonSort<0, 32>::run(first, lessThan); return;
+  default: insertionSort(first, first + numElements, lessThan); return;
+  }
+}
+
+
+/// merge two sorted neighboring ranges, the left one is moved into "buffer" first
+template <typename iterator, typename Value, typename LessThan>
+void smallSortMerge(iterator first, iterator mid, iterator last, Value* buffer, LessThan lessThan, std::false_type)
+{
+  mergeWithBuffer(first, mid, last, buffer, lessThan);
+}
+
+
+/// merge two sorted neighboring ranges without branches (cheap comparisons only), the left one is copied into "buffer" first
+template <typename iterator, typename Value, typename LessThan>
+void smallSortMerge(iterator first, iterator mid, iterator last, Value* buffer, LessThan lessThan, std::true_type)
+{
+  auto left    = buffer;
+  auto leftEnd = std::copy(first, mid, buffer);
+  auto right   = mid;
+  auto output  = first;
+  while (left != leftEnd && right != last)
+  {
+    // prefer left element if equal
+    bool takeRight = lessThan(*right, *left);
+    *output++ = takeRight ? *right : *left;
+    right += takeRight;
+    left  += !takeRight;
+  }
+
+  // remaining elements of the right range are already in place
+  std::copy(left, leftEnd, output);
+}
+
+
+/// merge two sorted neighboring ranges, the left one (at most 32 elements) is copied to uninitialized memory on the stack
+template <typename iterator, typename LessThan>
+void smallSortMergeHalves(iterator first, iterator mid, iterator last, LessThan lessThan, std::true_type)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  // trivially copyable values don't need to be constructed
+  alignas(Value) unsigned char storage[32 * sizeof(Value)];
+  smallSortMerge(first, mid, last, reinterpret_cast<Value*>(storage), lessThan, IsCheapComparison<Value, LessThan>());
+}
+
+/// merge two sorted neighboring ranges in-place (no default constructor required, no objects constructed)
+template <typename iterator, typename LessThan>
+void smallSortMergeHalves(iterator first, iterator mid, iterator last, LessThan lessThan, std::false_type)
+{
+  mergeWithoutBuffer(first, mid, last, mid - first, last - mid, lessThan);
+}
+
+
+/// sort up to 64 elements: sorting networks for both halves, then merge them
+template <typename iterator, typename LessThan>
+void smallSortMerge(iterator first, size_t numElements, LessThan lessThan)
+{
+  if (numElements <= 32)
+  {
+    smallSortNetwork(first, numElements, lessThan);
+    return;
+  }
+
+  auto firstHalf = numElements / 2;
+  smallSortMerge(first,             firstHalf,               lessThan);
+  smallSortMerge(first + firstHalf, numElements - firstHalf, lessThan);
+
+  // already in order ?
+  auto mid = first + firstHalf;
+  if (!lessThan(*mid, *(mid - 1)))
+    return;
+
+  // left half has at most 32 elements
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  smallSortMergeHalves(first, mid, first + numElements, lessThan, std::is_trivially_copyable<Value>());
+}
+
+
+/// sort up to 64 elements with sorting networks, more elements are handled by Intro Sort (random-access iterators)
+template <typename iterator, typename LessThan>
+void smallSort(iterator first, iterator last, LessThan lessThan, std::random_access_iterator_tag)
+{
+  size_t numElements = last - first;
+  if (numElements > 64)
+  {
+    introSort(first, last, lessThan, SortTuningIntroSortCutoff, numElements);
+    return;
+  }
+
+  smallSortMerge(first, numElements, lessThan);
+}
+
+
+/// sorting networks require random-access iterators, fall back to Intro Sort for bidirectional iterators
+template <typename iterator, typename LessThan>
+void smallSort(iterator first, iterator last, LessThan lessThan, std::bidirectional_iterator_tag)
+{
+  introSort(first, last, lessThan);
+}
+
+
+/// sorting networks require random-access iterators, fall back to Quick Sort (Lomuto partitioning) for forward iterators
+template <typename iterator, typename LessThan>
+void smallSort(iterator first, iterator last, LessThan lessThan, std::forward_iterator_tag)
+{
+  quickSort(first, last, lessThan);
+}
+
+
+/// sort tiny ranges (up to 64 elements) with minimal overhead, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+void smallSort(iterator first, iterator last, LessThan lessThan)
+{
+  smallSort(first, last, lessThan, typename std::iterator_traits<iterator>::iterator_category());
+}
+
+
+/// sort tiny ranges (up to 64 elements) with minimal overhead, default less-than operator
+template <typename iterator>
+void smallSort(iterator first, iterator last)
+{
+  smallSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// K-way merge with a tournament tree of losers: each output element costs log2(K) comparisons
+template <typename Source, typename LessThan>
+class LoserTree
+{
+public:
+  /// sorted input ranges [first[i], last[i])
+  LoserTree(const std::vector<Source>& first, const std::vector<Source>& last, LessThan lessThan)
+  : current(first), last(last), lessThan(lessThan), numLeaves(1)
+  {
+    // round up to a power of two, the extra leaves are empty
+    while (numLeaves < first.size())
+      numLeaves *= 2;
+    current.resize(numLeaves, Source());
+    this->last.resize(numLeaves, Source());
+    tree.resize(numLeaves);
+    tree[0] = build(1);
+  }
+
+  /// index of the range with the smallest element or numLeaves if all are exhausted
+  size_t winner() const
+  {
+    return isEmpty(tree[0]) ? numLeaves : tree[0];
+  }
+
+  /// advance the winner's range, return the position of its smallest element (which is still valid)
+  Source pop()
+  {
+    auto winner = tree[0];
+    auto result = current[winner]++;
+
+    // replay matches on the path to the root
+    for (auto node = (winner + numLeaves) / 2; node > 0; node /= 2)
+      if (beats(tree[node], winner))
+        std::swap(tree[node], winner);
+    tree[0] = winner;
+    return result;
+  }
+
+private:
+  /// true if range is exhausted
+  bool isEmpty(size_t leaf) const
+  {
+    return current[leaf] == last[leaf];
+  }
+
+  /// true if range "a" has a smaller element than range "b", exhausted ranges always lose,
+  /// equal elements: the range with the lower index wins (=> stable)
+  bool beats(size_t a, size_t b) const
+  {
+    if (isEmpty(a))
+      return false;
+    if (isEmpty(b))
+      return true;
+    if (a < b)
+      return !lessThan(*current[b], *current[a]);
+    return lessThan(*current[a], *current[b]);
+  }
+
+  /// initial tournament, return winner of the subtree
+  size_t build(size_t node)
+  {
+    if (node >= numLeaves)
+      return node - numLeaves;
+
+    auto left  = build(2 * node);
+    auto right = build(2 * node + 1);
+    if (beats(right, left))
+    {
+      tree[node] = left;
+      return right;
+    }
+    tree[node] = right;
+    return left;
+  }
+
+  /// current position of each range
+  std::vector<Source> current;
+  /// end of each range
+  std::vector<Source> last;
+  /// user-defined less-than operator
+  LessThan lessThan;
+  /// number of leaves (a power of two)
+  size_t numLeaves;
+  /// losers of each match (tree[0] is the overall winner)
+  std::vector<size_t> tree;
+};
+
+
+/// store a trivially copyable element, bypass the cache with non-temporal stores when possible (x86-64: 4 and 8 byte elements)
+template <typename Value>
+void streamStore(Value* to, Value& value, std::true_type)
+{
+#if defined(__SSE2__) && defined(__x86_64__)
+  if (sizeof(Value) == 4)
+  {
+    int bits;
+    memcpy(&bits, &value, 4);
+    _mm_stream_si32((int*)to, bits);
+    return;
+  }
+  if (sizeof(Value) == 8)
+  {
+    long long bits;
+    memcpy(&bits, &value, 8);
+    _mm_stream_si64((long long*)to, bits);
+    return;
+  }
+#endif
+  *to = value;
+}
+
+/// store an element
+template <typename Value>
+void streamStore(Value* to, Value& value, std::false_type)
+{
+  *to = std::move(value);
+}
+
+/// store an element, bypass the cache with non-temporal stores when possible
+template <typename Value>
+void streamStore(Value* to, Value& value)
+{
+  streamStore(to, value, std::is_trivially_copyable<Value>());
+}
+
+
+/// tiled Merge Sort (random-access iterators): sort cache-sized tiles with bottom-up Merge Sort,
+/// then merge all tiles at once with a loser tree => about three passes over main memory, regardless of the input size
+/// tiles have "tileBytes" bytes, the sort is stable (requires additional memory)
+template <typename iterator, typename LessThan>
+void mergeSortTiled(iterator first, iterator last, LessThan lessThan, size_t tileBytes)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+
+  size_t numElements = last - first;
+  if (numElements <= 1)
+    return;
+  size_t tileSize    = tileBytes / sizeof(Value);
+  if (tileSize < 64)
+    tileSize = 64;
+
+  // sort each tile while it's in the cache, the front of the buffer is every tile's scratch memory (stays in the cache, too)
+  ScratchBuffer<Value> buffer(numElements, first);
+  std::vector<iterator> tileFirst, tileLast;
+  for (size_t tile = 0; tile < numElements; tile += tileSize)
+  {
+    auto tileEnd = std::min(tile + tileSize, numElements);
+    mergeSortBottomUp(first + tile, first + tileEnd, lessThan, buffer.data(), std::random_access_iterator_tag());
+    tileFirst.push_back(first + tile);
+    tileLast .push_back(first + tileEnd);
+  }
+  if (tileFirst.size() <= 1)
+    return;
+
+  // K-way merge into the buffer, bypassing the cache
+  LoserTree<iterator, LessThan> tree(tileFirst, tileLast, lessThan);
+  for (auto& output : buffer)
+    streamStore(&output, *tree.pop());
+#if defined(__SSE2__) && defined(__x86_64__)
+  _mm_sfence();
+#endif
+
+  std::move(buffer.begin(), buffer.end(), first);
+}
+
+
+/// tiled Merge Sort, tile size can be tuned in sort_tuning.h (requires additional memory)
+template <typename iterator, typename LessThan>
+void mergeSortTiled(iterator first, iterator last, LessThan lessThan)
+{
+  mergeSortTiled(first, last, lessThan, SortTuningTileBytes);
+}
+
+
+/// tiled Merge Sort without any heap allocations: falls back to Merge Sort with in-place merging
+/// (the K-way merge needs an output buffer and the tiles' boundaries)
+template <typename iterator, typename LessThan>
+void mergeSortTiled(iterator first, iterator last, LessThan lessThan, NoAlloc)
+{
+  mergeSort(first, last, lessThan, NoAlloc());
+}
+
+
+/// tiled Merge Sort with default less-than operator (requires additional memory)
+template <typename iterator>
+void mergeSortTiled(iterator first, iterator last)
+{
+  mergeSortTiled(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+// string sorting
+// the following algorithms sort std::string, std::string_view, const char* etc. lexicographically
+// (comparing unsigned bytes, shorter strings come first) - they don't accept a less-than operator
+// because they need access to single characters instead of whole strings
+
+
+/// return character at position "depth" (0..255) or -1 if string is shorter
+template <typename String>
+int stringCharAt(const String& text, size_t depth)
+{
+  return depth < text.size() ? (unsigned char)text[depth] : -1;
+}
+
+/// return character at position "depth" (0..255) or -1 if string is shorter
+inline int stringCharAt(const char* text, size_t depth)
+{
+  // caller guarantees that all characters before "depth" are not zero
+  return text[depth] != 0 ? (unsigned char)text[depth] : -1;
+}
+
+/// return character at position "depth" (0..255) or -1 if string is shorter
+inline int stringCharAt(char* text, size_t depth)
+{
+  return stringCharAt((const char*)text, depth);
+}
+
+
+/// compare two strings, skip the first "depth" characters (which are known to be identical)
+/// return a negative number if a < b, positive if a > b or zero if identical
+/// on return "depth" contains the length of the longest common prefix
+template <typename String>
+int stringCompare(const String& a, const String& b, size_t& depth)
+{
+  while (true)
+  {
+    auto charA = stringCharAt(a, depth);
+    auto charB = stringCharAt(b, depth);
+    if (charA != charB)
+      return charA < charB ? -1 : +1;
+    // reached end of both strings ?
+    if (charA < 0)
+      return 0;
+    depth++;
+  }
+}
+
+
+/// Insertion Sort for strings, the first "depth" characters of all strings are identical
+template <typename iterator>
+void stringInsertionSort(iterator first, iterator last, size_t depth)
+{
+  if (first == last)
+    return;
+
+  auto current = first;
+  ++current;
+  while (current != last)
+  {
+    auto compare = std::move(*current);
+
+    // find location inside sorted range, beginning from the right end
+    auto pos = current;
+    while (pos != first)
+    {
+      auto left = pos;
+      --left;
+      auto common = depth;
+      if (stringCompare(compare, *left, common) >= 0)
+        break;
+
+      *pos = std::move(*left);
+      pos  = std::move( left);
+    }
+
+    *pos = std::move(compare);
+    ++current;
+  }
+}
+
+
+/// Multikey Quick Sort (three-way radix quicksort by Bentley and Sedgewick)
+/// the first "depth" characters of all strings are identical
+template <typename iterator>
+void multikeyQuickSort(iterator first, iterator last, size_t depth)
+{
+  while (true)
+  {
+    auto numElements = std::distance(first, last);
+    if (numElements <= 16)
+    {
+      stringInsertionSort(first, last, depth);
+      return;
+    }
+
+    // median-of-three of the current characters
+    auto low    = stringCharAt(*first, depth);
+    auto middle = stringCharAt(*(first + numElements/2), depth);
+    auto high   = stringCharAt(*(last - 1), depth);
+    if (low > middle)
+      std::swap(low, middle);
+    if (middle > high)
+      middle = low > high ? low : high;
+    auto pivot = middle;
+
+    // three-way partition: [first,less) < pivot, [less,greater) == pivot, [greater,last) > pivot
+    auto less    = first;
+    auto greater = last;
+    auto scan    = first;
+    while (scan != greater)
+    {
+      auto current = stringCharAt(*scan, depth);
+      if (current < pivot)
+        std::iter_swap(less++, scan++);
+      else if (current > pivot)
+        std::iter_swap(scan, --greater);
+      else
+        ++scan;
+    }
+
+    // strings with smaller and equal current character
+    multikeyQuickSort(first, less, depth);
+    // all strings of the middle partition ended => they are identical
+    if (pivot >= 0)
+      multikeyQuickSort(less, greater, depth + 1);
+
+    // strings with larger current character (loop instead of recursion)
+    first = greater;
+  }
+}
+
+
+/// Multikey Quick Sort (three-way radix quicksort by Bentley and Sedgewick)
+template <typename iterator>
+void multikeyQuickSort(iterator first, iterator last)
+{
+  multikeyQuickSort(first, last, 0);
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// MSD Radix Sort for strings (in-place, "American flag sort"), the first "depth" characters of all strings are identical
+template <typename iterator>
+void stringRadixSort(iterator first, iterator last, size_t depth)
+{
+  // small buckets are faster processed by Multikey Quick Sort
+  const size_t SmallBucket = 64;
+
+  size_t numElements = std::distance(first, last);
+  while (numElements > SmallBucket)
+  {
+    // histogram of current characters, bucket 0 is reserved for "string ends here"
+    size_t count[256 + 1] = { 0 };
+    for (auto scan = first; scan != last; ++scan)
+      count[stringCharAt(*scan, depth) + 1]++;
+
+    // all strings share the same character ? => look at next character without recursion
+    if (count[stringCharAt(*first, depth) + 1] == numElements)
+    {
+      // all strings ended ? => identical
+      if (count[0] == numElements)
+        return;
+      depth++;
+      continue;
+    }
+
+    // start of each bucket
+    size_t next[256 + 1];
+    size_t sum = 0;
+    for (size_t bucket = 0; bucket <= 256; bucket++)
+    {
+      next[bucket] = sum;
+      sum += count[bucket];
+    }
+
+    // swap each string to its bucket, following the permutation cycles
+    size_t bucketEnd = 0;
+    for (size_t bucket = 0; bucket <= 256; bucket++)
+    {
+      bucketEnd += count[bucket];
+      while (next[bucket] < bucketEnd)
+      {
+        auto current = first + next[bucket];
+        size_t target;
+        while ((target = size_t(stringCharAt(*current, depth) + 1)) != bucket)
+          std::iter_swap(current, first + next[target]++);
+        next[bucket]++;
+      }
+    }
+
+    // bucket 0 contains only identical strings, process all other buckets
+    auto bucketFirst = first + count[0];
+    for (size_t bucket = 1; bucket <= 256; bucket++)
+    {
+      if (count[bucket] > 1)
+        stringRadixSort(bucketFirst, bucketFirst + count[bucket], depth + 1);
+      bucketFirst += count[bucket];
+    }
+    return;
+  }
+
+  multikeyQuickSort(first, last, depth);
+}
+
+
+/// MSD Radix Sort for strings (in-place, "American flag sort")
+template <typename iterator>
+void stringRadixSort(iterator first, iterator last)
+{
+  stringRadixSort(first, last, 0);
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// LCP Merge Sort for strings, sorts "numElements" strings and stores the longest common prefix
+/// of each string and its predecessor in "lcp" (lcp[0] = 0)
+template <typename iterator, typename Value>
+void lcpMergeSort(iterator first, size_t numElements, size_t* lcp, Value* buffer, size_t* lcpBuffer)
+{
+  if (numElements <= 1)
+  {
+    lcp[0] = 0;
+    return;
+  }
+
+  // divide into two partitions and sort them recursively
+  auto firstHalf = numElements / 2;
+  lcpMergeSort(first,             firstHalf,               lcp,             buffer, lcpBuffer);
+  lcpMergeSort(first + firstHalf, numElements - firstHalf, lcp + firstHalf, buffer, lcpBuffer);
+
+  // merge into buffer: both heads know their common prefix with the most recently merged string,
+  // so only strings with the same common prefix have to be compared (and only beyond that prefix)
+  size_t left  = 0;
+  size_t right = firstHalf;
+  size_t lcpLeft  = 0;
+  size_t lcpRight = 0;
+  size_t out = 0;
+  while (left < firstHalf && right < numElements)
+  {
+    bool takeLeft;
+    if (lcpLeft != lcpRight)
+    {
+      // the string sharing a longer prefix with the previous output is smaller
+      takeLeft = lcpLeft > lcpRight;
+      lcpBuffer[out] = takeLeft ? lcpLeft : lcpRight;
+    }
+    else
+    {
+      auto common = lcpLeft;
+      takeLeft = stringCompare(*(first + left), *(first + right), common) <= 0;
+      lcpBuffer[out] = lcpLeft;
+      // the other head is now compared to the string we are about to output
+      if (takeLeft)
+        lcpRight = common;
+      else
+        lcpLeft  = common;
+    }
+
+    if (takeLeft)
+    {
+      buffer[out++] = std::move(*(first + left));
+      if (++left < firstHalf)
+        lcpLeft = lcp[left];
+    }
+    else
+    {
+      buffer[out++] = std::move(*(first + right));
+      if (++right < numElements)
+        lcpRight = lcp[right];
+    }
+  }
+
+  // copy remaining strings, the first of them needs its common prefix with the last merged string
+  if (left < firstHalf)
+  {
+    lcp[left] = lcpLeft;
+    for (; left < firstHalf; left++, out++)
+    {
+      buffer   [out] = std::move(*(first + left));
+      lcpBuffer[out] = lcp[left];
+    }
+  }
+  if (right < numElements)
+  {
+    lcp[right] = lcpRight;
+    for (; right < numElements; right++, out++)
+    {
+      buffer   [out] = std::move(*(first + right));
+      lcpBuffer[out] = lcp[right];
+    }
+  }
+
+  // move back
+  for (size_t i = 0; i < numElements; i++)
+  {
+    *(first + i) = std::move(buffer[i]);
+    lcp[i]       = lcpBuffer[i];
+  }
+}
+
+
+/// LCP Merge Sort for strings (stable, requires additional memory)
+template <typename iterator>
+void lcpMergeSort(iterator first, iterator last)
+{
+  size_t numElements = std::distance(first, last);
+  if (numElements <= 1)
+    return;
+
+  std::vector<typename std::iterator_traits<iterator>::value_type> buffer(numElements);
+  std::vector<size_t> lcp(numElements), lcpBuffer(numElements);
+  lcpMergeSort(first, numElements, lcp.data(), buffer.data(), lcpBuffer.data());
+}
+
+
+/// LCP Merge Sort for strings with caller-provided scratch memory:
+/// "buffer" must hold at least as many strings as the input, "lcp" twice as many numbers
+template <typename iterator>
+void lcpMergeSort(iterator first, iterator last,
+                  typename std::iterator_traits<iterator>::value_type* buffer, size_t* lcp)
+{
+  size_t numElements = std::distance(first, last);
+  if (numElements <= 1)
+    return;
+
+  lcpMergeSort(first, numElements, lcp, buffer, lcp + numElements);
+}
+
+
+/// LCP Merge Sort can't work without scratch memory
+template <typename iterator>
+void lcpMergeSort(iterator first, iterator last, NoAlloc)
+{
+  static_assert(sizeof(iterator) == 0,
+                "lcpMergeSort needs scratch memory: provide a buffer or use multikeyQuickSort / stringRadixSort");
+}
+
+
+#if __cplusplus >= 201703L
+/// LCP Merge Sort for strings, scratch memory is taken from a user-defined memory resource
+template <typename iterator>
+void lcpMergeSort(iterator first, iterator last, std::pmr::memory_resource* resource)
+{
+  size_t numElements = std::distance(first, last);
+  if (numElements <= 1)
+    return;
+
+  std::pmr::vector<typename std::iterator_traits<iterator>::value_type> buffer(numElements, resource);
+  std::pmr::vector<size_t> lcp(2 * numElements, resource);
+  lcpMergeSort(first, numElements, lcp.data(), buffer.data(), lcp.data() + numElements);
+}
+#endif
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// three-way Quick Sort (Dijkstra), elements equal to the pivot are never touched again
+template <typename iterator, typename LessThan>
+void quickSort3Way(iterator first, iterator last, LessThan lessThan)
+{
+  while (true)
+  {
+    auto numElements = std::distance(first, last);
+    if (numElements <= 16)
+    {
+      insertionSort(first, last, lessThan);
+      return;
+    }
+
+    // choose middle element as pivot
+    auto pivot = *(first + numElements/2);
+
+    // [first,less) < pivot, [less,scan) == pivot, [greater,last) > pivot
+    auto less    = first;
+    auto greater = last;
+    auto scan    = first;
+    while (scan != greater)
+    {
+      if (lessThan(*scan, pivot))
+        std::iter_swap(less++, scan++);
+      else if (lessThan(pivot, *scan))
+        std::iter_swap(scan, --greater);
+      else
+        ++scan;
+    }
+
+    // recurse into smaller partition, loop on larger partition
+    if (less - first < last - greater)
+    {
+      quickSort3Way(first, less, lessThan);
+      first = greater;
+    }
+    else
+    {
+      quickSort3Way(greater, last, lessThan);
+      last = less;
+    }
+  }
+}
+
+
+/// three-way Quick Sort with default less-than operator
+template <typename iterator>
+void quickSort3Way(iterator first, iterator last)
+{
+  quickSort3Way(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// sort and merge equal elements (random-access iterators): three-way Quick Sort which collapses all elements
+/// equal to the pivot into a single element as soon as they are found
+/// "combine(a, b)" merges element b into the equal element a (e.g. add counters), it's called in no particular order
+/// return new end of the range, all elements beyond it are in a valid but unspecified state
+template <typename iterator, typename LessThan, typename Combine>
+iterator sortReduce(iterator first, iterator last, LessThan keyLess, Combine combine)
+{
+  // [output of the first call, output) and [tailFirst, tailLast) are already reduced,
+  // all elements of the prefix are smaller and all elements of the suffix are larger than [first,last)
+  auto output    = first;
+  auto tailFirst = last;
+  auto tailLast  = last;
+
+  while (last - first > 16)
+  {
+    auto pivot = *PivotMedianOf3::select(first, last, last - first, keyLess);
+
+    // [first,less) < pivot, [less,scan) == pivot, [greater,last) > pivot
+    auto less    = first;
+    auto greater = last;
+    auto scan    = first;
+    while (scan != greater)
+    {
+      if (keyLess(*scan, pivot))
+        std::iter_swap(less++, scan++);
+      else if (keyLess(pivot, *scan))
+        std::iter_swap(scan, --greater);
+      else
+        ++scan;
+    }
+
+    // collapse all elements equal to the pivot
+    for (auto equal = less + 1; equal != greater; ++equal)
+      combine(*less, *equal);
+    auto merged = std::move(*less);
+
+    // recursion into the smaller partition only, loop on the larger one => stack depth is O(log n)
+    if (less - first < last - greater)
+    {
+      // smaller elements: append them and the merged pivot to the prefix
+      auto reduced = sortReduce(first, less, keyLess, combine);
+      output = (output == first) ? reduced : std::move(first, reduced, output);
+      *output++ = std::move(merged);
+      first = greater;
+    }
+    else
+    {
+      // larger elements: prepend them and the merged pivot to the suffix
+      auto reduced = sortReduce(greater, last, keyLess, combine);
+      tailFirst = (reduced == tailFirst) ? greater : std::move_backward(greater, reduced, tailFirst);
+      *--tailFirst = std::move(merged);
+      last = less;
+    }
+  }
+
+  // small range: sort, then merge neighbors
+  if (first != last)
+  {
+    insertionSort(first, last, keyLess);
+    auto reduced = first;
+    for (auto scan = first + 1; scan != last; ++scan)
+    {
+      if (!keyLess(*reduced, *scan))
+        combine(*reduced, *scan);
+      else if (++reduced != scan)
+        *reduced = std::move(*scan);
+    }
+    ++reduced;
+    output = (output == first) ? reduced : std::move(first, reduced, output);
+  }
+
+  // close the gap between prefix and suffix
+  if (output == tailFirst)
+    return tailLast;
+  return std::move(tailFirst, tailLast, output);
+}
+
+
+/// sort and merge equal elements with default less-than operator, return new end of the range
+template <typename iterator, typename Combine>
+iterator sortReduce(iterator first, iterator last, Combine combine)
+{
+  return sortReduce(first, last, std::less<typename std::iterator_traits<iterator>::value_type>(), combine);
+}
+
+
+/// sort and remove duplicates (keeps an arbitrary one of several equal elements), allow user-defined less-than operator
+/// return new end of the range, all elements beyond it are in a valid but unspecified state
+template <typename iterator, typename LessThan>
+iterator sortUnique(iterator first, iterator last, LessThan lessThan)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  return sortReduce(first, last, lessThan, [](Value&, const Value&) {});
+}
+
+
+/// sort and remove duplicates with default less-than operator, return new end of the range
+template <typename iterator>
+iterator sortUnique(iterator first, iterator last)
+{
+  return sortUnique(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// map integers to unsigned keys with the same order (flip sign bit of signed integers)
+template <typename T>
+struct RadixKey
+{
+  typedef typename std::make_unsigned<T>::type Key;
+  Key operator()(const T& value) const
+  {
+    return Key(value) ^ (std::is_signed<T>::value ? Key(Key(1) << (8 * sizeof(Key) - 1)) : Key(0));
+  }
+};
+
+
+/// true if Radix Sort can replace a comparison-based sort
+template <typename T, typename LessThan>
+struct IsRadixSortable : std::integral_constant<bool,
+                           std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                           std::is_same<LessThan, std::less<T> >::value> {};
+
+
+/// one pass of LSD Radix Sort: distribute elements by the byte at position "shift"
+template <typename Source, typename Destination, typename KeyOf>
+void radixScatter(Source from, size_t numElements, Destination to, size_t* bucketStart, unsigned int shift, KeyOf keyOf)
+{
+  for (size_t i = 0; i < numElements; i++, ++from)
+  {
+    auto bucket = (keyOf(*from) >> shift) & 0xFF;
+    *(to + bucketStart[bucket]++) = std::move(*from);
+  }
+}
+
+
+/// LSD Radix Sort with caller-provided scratch memory (at least as many elements as the input)
+/// "keyOf" maps each element to an unsigned integer
+template <typename iterator, typename KeyOf>
+void radixSortByKey(iterator first, iterator last, typename std::iterator_traits<iterator>::value_type* scratch, KeyOf keyOf)
+{
+  typedef decltype(keyOf(*first)) Key;
+  const unsigned int NumPasses = sizeof(Key);
+
+  size_t numElements = std::distance(first, last);
+  if (numElements <= 1)
+    return;
+
+  // histograms of all bytes in a single pass (on the stack: at most 16 KB, no heap allocation)
+  size_t histogram[NumPasses * 256] = { 0 };
+  for (auto scan = first; scan != last; ++scan)
+  {
+    auto key = keyOf(*scan);
+    for (unsigned int pass = 0; pass < NumPasses; pass++)
+      histogram[pass * 256 + ((key >> (8 * pass)) & 0xFF)]++;
+  }
+
+  // data resides either in the input range or in the scratch buffer
+  bool inScratch = false;
+  auto firstKey = keyOf(*first);
+  for (unsigned int pass = 0; pass < NumPasses; pass++)
+  {
+    size_t* count = &histogram[pass * 256];
+    // all elements share the same byte ? => skip pass
+    if (count[(firstKey >> (8 * pass)) & 0xFF] == numElements)
+      continue;
+
+    // convert counts to start offsets
+    size_t sum = 0;
+    for (unsigned int bucket = 0; bucket < 256; bucket++)
+    {
+      auto current  = count[bucket];
+      count[bucket] = sum;
+      sum += current;
+    }
+
+    if (inScratch)
+      radixScatter(scratch, numElements, first,   count, 8 * pass, keyOf);
+    else
+      radixScatter(first,   numElements, scratch, count, 8 * pass, keyOf);
+    inScratch = !inScratch;
+  }
+
+  if (inScratch)
+    std::move(scratch, scratch + numElements, first);
+}
+
+
+/// LSD Radix Sort for integers with caller-provided scratch memory (at least as many elements as the input)
+template <typename iterator>
+void radixSort(iterator first, iterator last, typename std::iterator_traits<iterator>::value_type* scratch)
+{
+  radixSortByKey(first, last, scratch, RadixKey<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// LSD Radix Sort for integers (requires additional memory)
+template <typename iterator>
+void radixSort(iterator first, iterator last)
+{
+  ScratchBuffer<typename std::iterator_traits<iterator>::value_type> scratch(std::distance(first, last));
+  radixSort(first, last, scratch.data());
+}
+
+
+/// LSD Radix Sort can't work without scratch memory
+template <typename iterator>
+void radixSort(iterator first, iterator last, NoAlloc)
+{
+  static_assert(sizeof(iterator) == 0,
+                "radixSort needs scratch memory: provide a buffer or use a comparison-based sort");
+}
+
+
+#if __cplusplus >= 201703L
+/// LSD Radix Sort for integers, scratch memory is taken from a user-defined memory resource
+template <typename iterator>
+void radixSort(iterator first, iterator last, std::pmr::memory_resource* resource)
+{
+  std::pmr::vector<typename std::iterator_traits<iterator>::value_type> scratch(std::distance(first, last), resource);
+  radixSort(first, last, scratch.data());
+}
+#endif
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// where floatSort puts NaNs
+enum FloatSortNaN
+{
+  FloatSortNaNFirst,
+  FloatSortNaNLast
+};
+
+/// how floatSort orders -0.0 and +0.0
+enum FloatSortZero
+{
+  FloatSortZeroEqual,         // both are equal (like std::less), Radix Sort keeps their original order
+  FloatSortNegativeZeroFirst  // -0.0 < +0.0
+};
+
+
+/// map IEEE-754 floats/doubles to unsigned keys with the same order:
+/// flip all bits of negative numbers, flip only the sign bit of positive numbers, NaNs become the smallest or largest key
+template <typename T>
+struct FloatKey
+{
+  static_assert(std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8),
+                "FloatKey supports only IEEE-754 float and double");
+  typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type Key;
+
+  explicit FloatKey(FloatSortNaN nan = FloatSortNaNLast, FloatSortZero zero = FloatSortZeroEqual)
+  : nanKey(nan == FloatSortNaNFirst ? Key(0) : ~Key(0)), zerosEqual(zero == FloatSortZeroEqual)
+  {
+    T inf = std::numeric_limits<T>::infinity();
+    memcpy(&infinity, &inf, sizeof(infinity));
+  }
+
+  Key operator()(const T& value) const
+  {
+    const Key SignBit = Key(1) << (8 * sizeof(Key) - 1);
+    Key bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    // all NaNs (any sign, any payload) are equal, no other number is mapped to 0 or ~0
+    if ((bits & ~SignBit) > infinity)
+      return nanKey;
+    // -0.0 => +0.0
+    if (zerosEqual && bits == SignBit)
+      bits = 0;
+    return (bits & SignBit) ? ~bits : (bits | SignBit);
+  }
+
+private:
+  /// bit pattern of +infinity, larger patterns (without sign bit) are NaNs
+  Key  infinity;
+  /// key of all NaNs
+  Key  nanKey;
+  /// map -0.0 to +0.0
+  bool zerosEqual;
+};
+
+
+/// strict weak ordering of floats/doubles, including NaNs (unlike std::less), compares integer keys
+template <typename T>
+struct FloatLess
+{
+  explicit FloatLess(FloatSortNaN nan = FloatSortNaNLast, FloatSortZero zero = FloatSortZeroEqual)
+  : keyOf(nan, zero) {}
+
+  bool operator()(const T& a, const T& b) const
+  {
+    return keyOf(a) < keyOf(b);
+  }
+
+private:
+  FloatKey<T> keyOf;
+};
+
+
+/// floatSort prefers Radix Sort if there are at least this many elements (much lower than for integers
+/// because comparison-based algorithms have to compute two keys per comparison)
+const size_t FloatSortMinRadixSize = 256;
+
+/// sort floats/doubles, random-access iterators: Radix Sort on integer keys for large inputs,
+/// else three-way Quick Sort on integer keys (all NaNs are equal, plain Intro Sort degrades with many duplicates)
+template <typename iterator>
+void floatSort(iterator first, iterator last, FloatSortNaN nan, FloatSortZero zero, std::random_access_iterator_tag)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+
+  size_t numElements = std::distance(first, last);
+  if (numElements < FloatSortMinRadixSize)
+  {
+    quickSort3Way(first, last, FloatLess<Value>(nan, zero));
+    return;
+  }
+
+  ScratchBuffer<Value> scratch(numElements);
+  radixSortByKey(first, last, scratch.data(), FloatKey<Value>(nan, zero));
+}
+
+/// sort floats/doubles, forward or bidirectional iterators: Merge Sort on integer keys
+template <typename iterator>
+void floatSort(iterator first, iterator last, FloatSortNaN nan, FloatSortZero zero, std::forward_iterator_tag)
+{
+  mergeSort(first, last, FloatLess<typename std::iterator_traits<iterator>::value_type>(nan, zero));
+}
+
+
+/// sort floats/doubles, NaNs are allowed and grouped at the front or back (total order, unlike std::less)
+template <typename iterator>
+void floatSort(iterator first, iterator last, FloatSortNaN nan, FloatSortZero zero = FloatSortZeroEqual)
+{
+  floatSort(first, last, nan, zero, typename std::iterator_traits<iterator>::iterator_category());
+}
+
+
+/// sort floats/doubles, NaNs are moved to the back, -0.0 and +0.0 are equal
+template <typename iterator>
+void floatSort(iterator first, iterator last)
+{
+  floatSort(first, last, FloatSortNaNLast);
+}
+
+
+/// sort floats/doubles without any heap allocations, random-access iterators: three-way Quick Sort on integer keys
+template <typename iterator>
+void floatSort(iterator first, iterator last, FloatSortNaN nan, FloatSortZero zero, NoAlloc, std::random_access_iterator_tag)
+{
+  quickSort3Way(first, last, FloatLess<typename std::iterator_traits<iterator>::value_type>(nan, zero));
+}
+
+/// sort floats/doubles without any heap allocations, forward or bidirectional iterators: Merge Sort with in-place merging
+template <typename iterator>
+void floatSort(iterator first, iterator last, FloatSortNaN nan, FloatSortZero zero, NoAlloc, std::forward_iterator_tag)
+{
+  mergeSort(first, last, FloatLess<typename std::iterator_traits<iterator>::value_type>(nan, zero), NoAlloc());
+}
+
+
+/// sort floats/doubles without any heap allocations
+template <typename iterator>
+void floatSort(iterator first, iterator last, FloatSortNaN nan, FloatSortZero zero, NoAlloc)
+{
+  floatSort(first, last, nan, zero, NoAlloc(), typename std::iterator_traits<iterator>::iterator_category());
+}
+
+
+/// sort floats/doubles without any heap allocations, NaNs are moved to the back, -0.0 and +0.0 are equal
+template <typename iterator>
+void floatSort(iterator first, iterator last, NoAlloc)
+{
+  floatSort(first, last, FloatSortNaNLast, FloatSortZeroEqual, NoAlloc());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// a key and the original position of its value, used by sortByKey
+template <typename Key, typename Index>
+struct KeyIndexPair
+{
+  Key   key;
+  Index index;
+};
+
+
+/// sort keys and their original positions: Radix Sort for integer keys
+template <typename Item, typename LessThan>
+void sortKeyIndexPairs(std::vector<Item>& items, LessThan /*lessThan*/, std::true_type)
+{
+  typedef decltype(items[0].key) Key;
+  ScratchBuffer<Item> scratch(items.size());
+  radixSortByKey(items.begin(), items.end(), scratch.data(),
+                 [](const Item& item) { return RadixKey<Key>()(item.key); });
+}
+
+
+/// sort keys and their original positions: Intro Sort for all other keys
+template <typename Item, typename LessThan>
+void sortKeyIndexPairs(std::vector<Item>& items, LessThan lessThan, std::false_type)
+{
+  introSort(items.begin(), items.end(),
+            [lessThan](const Item& a, const Item& b) { return lessThan(a.key, b.key); });
+}
+
+
+/// move values to their new positions, random-access iterators: follow the permutation's cycles in-place,
+/// each value is moved once (plus one temporary per cycle), "items" are marked as done
+template <typename valueIterator, typename Item>
+void permuteByIndex(valueIterator valuesFirst, std::vector<Item>& items, std::random_access_iterator_tag)
+{
+  typedef decltype(items[0].index) Index;
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    // already at its final position or moved as part of an earlier cycle ?
+    if (items[i].index == i)
+      continue;
+
+    auto   temporary = std::move(*(valuesFirst + i));
+    size_t current   = i;
+    while (true)
+    {
+      size_t source = items[current].index;
+      items[current].index = Index(current);
+      if (source == i)
+        break;
+      *(valuesFirst + current) = std::move(*(valuesFirst + source));
+      current = source;
+    }
+    *(valuesFirst + current) = std::move(temporary);
+  }
+}
+
+
+/// move values to their new positions, other iterators: gather them in a temporary array first (each value is moved twice)
+template <typename valueIterator, typename Item>
+void permuteByIndex(valueIterator valuesFirst, std::vector<Item>& items, std::forward_iterator_tag)
+{
+  typedef typename std::iterator_traits<valueIterator>::value_type Value;
+  std::vector<Value> values;
+  values.reserve(items.size());
+  auto value = valuesFirst;
+  for (size_t i = 0; i < items.size(); i++, ++value)
+    values.push_back(std::move(*value));
+
+  value = valuesFirst;
+  for (auto& item : items)
+    *value++ = std::move(values[item.index]);
+}
+
+
+/// sortByKey: sort keys with their original positions, then move keys and values to their final positions
+template <typename Index, typename keyIterator, typename valueIterator, typename LessThan>
+void sortByKey(keyIterator keysFirst, keyIterator keysLast, valueIterator valuesFirst, size_t numElements, LessThan lessThan)
+{
+  typedef typename std::iterator_traits<keyIterator>::value_type Key;
+  typedef KeyIndexPair<Key, Index> Item;
+
+  // keys and positions only, values stay where they are
+  std::vector<Item> items(numElements);
+  Index index = 0;
+  for (auto key = keysFirst; key != keysLast; ++key, ++index)
+  {
+    items[index].key   = std::move(*key);
+    items[index].index = index;
+  }
+
+  sortKeyIndexPairs(items, lessThan, IsRadixSortable<Key, LessThan>());
+
+  // write back keys, then permute values
+  auto key = keysFirst;
+  for (auto& item : items)
+    *key++ = std::move(item.key);
+  permuteByIndex(valuesFirst, items, typename std::iterator_traits<valueIterator>::iterator_category());
+}
+
+
+/// sort keys and permute a separate range of values in lockstep (structure-of-arrays), allow user-defined less-than operator
+/// Radix Sort is used for integer keys with std::less, values are permuted in-place if valueIterator is a random-access iterator
+/// (each value is moved once), else through a temporary array (requires additional memory for keys and positions)
+template <typename keyIterator, typename valueIterator, typename LessThan>
+void sortByKey(keyIterator keysFirst, keyIterator keysLast, valueIterator valuesFirst, LessThan lessThan)
+{
+  size_t numElements = std::distance(keysFirst, keysLast);
+  if (numElements <= 1)
+    return;
+
+  // 32 bit positions keep the intermediate data smaller
+  if (numElements <= 0xFFFFFFFF)
+    sortByKey<uint32_t>(keysFirst, keysLast, valuesFirst, numElements, lessThan);
+  else
+    sortByKey<size_t>  (keysFirst, keysLast, valuesFirst, numElements, lessThan);
+}
+
+
+/// sort keys and permute a separate range of values in lockstep (structure-of-arrays) with default less-than operator
+template <typename keyIterator, typename valueIterator>
+void sortByKey(keyIterator keysFirst, keyIterator keysLast, valueIterator valuesFirst)
+{
+  sortByKey(keysFirst, keysLast, valuesFirst, std::less<typename std::iterator_traits<keyIterator>::value_type>());
+}
+
+
+/// sortByKey can't work without memory for its (key, position) pairs
+template <typename keyIterator, typename valueIterator, typename LessThan>
+void sortByKey(keyIterator keysFirst, keyIterator keysLast, valueIterator valuesFirst, LessThan lessThan, NoAlloc)
+{
+  static_assert(sizeof(keyIterator) == 0,
+                "sortByKey needs memory for its (key, position) pairs: sort an array of (key, value) pairs instead");
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// Insertion Sort which gives up if more than "maxMoves" elements have to be shifted
+/// return true if sorted, false if aborted (then the range is still a permutation of the input)
+template <typename iterator, typename LessThan>
+bool partialInsertionSort(iterator first, iterator last, LessThan lessThan, size_t maxMoves)
+{
+  if (first == last)
+    return true;
+
+  size_t numMoves = 0;
+  auto current = first;
+  for (++current; current != last; ++current)
+  {
+    auto left = current;
+    --left;
+    // already in correct order ?
+    if (!lessThan(*current, *left))
+      continue;
+
+    auto compare = std::move(*current);
+    auto pos = current;
+    do
+    {
+      *pos = std::move(*left);
+      pos  = left;
+      numMoves++;
+    } while (pos != first && lessThan(compare, *--left));
+    *pos = std::move(compare);
+
+    if (numMoves > maxMoves)
+      return false;
+  }
+
+  return true;
+}
+
+
+/// tunable thresholds of autoSort
+struct AutoSortThresholds
+{
+  /// Insertion Sort for up to this many elements
+  size_t smallSize;
+  /// try Insertion Sort if at most this fraction of sampled neighbors is in wrong order
+  double maxUnsorted;
+  /// ... but give up if more than maxMovesPerElement * numElements elements have to be shifted
+  size_t maxMovesPerElement;
+  /// three-way Quick Sort if at least this fraction of sampled elements are duplicates
+  double minDuplicates;
+  /// Radix Sort for integers if at least this many elements ...
+  size_t minRadixSize;
+  /// ... and if sampled keys differ in at most this many bits
+  unsigned int maxRadixBits;
+
+  /// set default values
+  AutoSortThresholds()
+  : smallSize(SortTuningIntroSortCutoff), maxUnsorted(0.02), maxMovesPerElement(4),
+    minDuplicates(0.5), minRadixSize(SortTuningMinRadixSize), maxRadixBits(32) {}
+};
+
+
+/// algorithms picked by autoSort
+enum AutoSortChoice
+{
+  AutoSortInsertion,
+  AutoSortReverseInsertion,
+  AutoSortQuick3Way,
+  AutoSortRadix,
+  AutoSortQuickIterative
+};
+
+
+/// human-readable name of an algorithm picked by autoSort
+inline const char* autoSortName(AutoSortChoice choice)
+{
+  switch (choice)
+  {
+  case AutoSortInsertion:        return "Insertion Sort";
+  case AutoSortReverseInsertion: return "reverse + Insertion Sort";
+  case AutoSortQuick3Way:        return "three-way Quick Sort";
+  case AutoSortRadix:            return "Radix Sort";
+  default:                       return "iterative Quick Sort";
+  }
+}
+
+
+/// number of bits in which the sampled keys differ (only for types supported by Radix Sort)
+template <typename Value>
+unsigned int autoSortKeyBits(const std::vector<Value>& sample, std::true_type)
+{
+  RadixKey<Value> keyOf;
+  typename RadixKey<Value>::Key diff = 0;
+  for (auto& value : sample)
+    diff |= keyOf(value) ^ keyOf(sample.front());
+
+  unsigned int bits = 0;
+  for (; diff != 0; diff >>= 1)
+    bits++;
+  return bits;
+}
+
+/// Radix Sort not supported
+template <typename Value>
+unsigned int autoSortKeyBits(const std::vector<Value>&, std::false_type)
+{
+  return ~0U;
+}
+
+
+/// look at about sqrt(n) elements to decide which algorithm works best
+template <typename iterator, typename LessThan>
+AutoSortChoice autoSortSelect(iterator first, iterator last, LessThan lessThan,
+                              const AutoSortThresholds& thresholds = AutoSortThresholds())
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+
+  size_t numElements = std::distance(first, last);
+  if (numElements <= thresholds.smallSize)
+    return AutoSortInsertion;
+
+  // look at neighbors at evenly spaced positions
+  size_t sampleSize = 1;
+  while (sampleSize * sampleSize < numElements)
+    sampleSize++;
+  size_t stride = (numElements - 1) / sampleSize;
+
+  size_t ascending  = 0;
+  size_t descending = 0;
+  std::vector<Value> sample;
+  sample.reserve(sampleSize);
+  auto current = first;
+  for (size_t i = 0; i < sampleSize; i++)
+  {
+    auto next = current;
+    ++next;
+    if (lessThan(*current, *next))
+      ascending++;
+    else if (lessThan(*next, *current))
+      descending++;
+    sample.push_back(*current);
+    std::advance(current, stride);
+  }
+
+  // (almost) sorted or reversed ?
+  // note: the sample itself must be ordered, too, not just its neighbors
+  if (descending <= thresholds.maxUnsorted * sampleSize &&
+      std::is_sorted(sample.begin(), sample.end(), lessThan))
+    return AutoSortInsertion;
+  if (ascending  <= thresholds.maxUnsorted * sampleSize &&
+      std::is_sorted(sample.rbegin(), sample.rend(), lessThan))
+    return AutoSortReverseInsertion;
+
+  // integers with a small range
+  if (numElements >= thresholds.minRadixSize &&
+      autoSortKeyBits(sample, IsRadixSortable<Value, LessThan>()) <= thresholds.maxRadixBits)
+    return AutoSortRadix;
+
+  // many duplicates
+  std::sort(sample.begin(), sample.end(), lessThan);
+  size_t duplicates = 0;
+  for (size_t i = 1; i < sampleSize; i++)
+    if (!lessThan(sample[i - 1], sample[i]))
+      duplicates++;
+  if (duplicates >= thresholds.minDuplicates * sampleSize)
+    return AutoSortQuick3Way;
+
+  // everything else: Intro Sort would become quadratic if a few keys are very frequent (but below minDuplicates)
+  return AutoSortQuickIterative;
+}
+
+
+/// run Radix Sort
+template <typename iterator, typename LessThan>
+void autoSortRadix(iterator first, iterator last, LessThan, std::true_type)
+{
+  radixSort(first, last);
+}
+
+/// Radix Sort not supported (never called, autoSortSelect doesn't choose it)
+template <typename iterator, typename LessThan>
+void autoSortRadix(iterator first, iterator last, LessThan lessThan, std::false_type)
+{
+  quickSortIterative(first, last, lessThan);
+}
+
+
+/// sample input and choose an algorithm accordingly, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+AutoSortChoice autoSort(iterator first, iterator last, LessThan lessThan,
+                        const AutoSortThresholds& thresholds = AutoSortThresholds())
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+
+  auto choice = autoSortSelect(first, last, lessThan, thresholds);
+
+  // limit work of Insertion Sort for larger inputs
+  size_t numElements = std::distance(first, last);
+  size_t maxMoves    = thresholds.maxMovesPerElement * numElements;
+  if (numElements <= thresholds.smallSize)
+    maxMoves = ~size_t(0);
+
+  switch (choice)
+  {
+  case AutoSortReverseInsertion:
+    std::reverse(first, last);
+    // fall through
+
+  case AutoSortInsertion:
+    // input wasn't as presorted as the sample suggested ? => continue with iterative Quick Sort
+    if (partialInsertionSort(first, last, lessThan, maxMoves))
+      break;
+    choice = AutoSortQuickIterative;
+    quickSortIterative(first, last, lessThan);
+    break;
+
+  case AutoSortQuick3Way:
+    quickSort3Way(first, last, lessThan);
+    break;
+
+  case AutoSortRadix:
+    autoSortRadix(first, last, lessThan, IsRadixSortable<Value, LessThan>());
+    break;
+
+  default:
+    quickSortIterative(first, last, lessThan);
+    break;
+  }
+
+  return choice;
+}
+
+
+/// sample input and choose an algorithm accordingly, default less-than operator
+template <typename iterator>
+AutoSortChoice autoSort(iterator first, iterator last)
+{
+  return autoSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// no sampling (which needs memory) and no Radix Sort: try Insertion Sort with a limited number of moves,
+/// else three-way Quick Sort (robust against duplicates), never allocates heap memory
+template <typename iterator, typename LessThan>
+AutoSortChoice autoSort(iterator first, iterator last, LessThan lessThan, NoAlloc,
+                        const AutoSortThresholds& thresholds = AutoSortThresholds())
+{
+  size_t numElements = std::distance(first, last);
+  size_t maxMoves    = thresholds.maxMovesPerElement * numElements;
+  if (numElements <= thresholds.smallSize)
+    maxMoves = ~size_t(0);
+
+  if (partialInsertionSort(first, last, lessThan, maxMoves))
+    return AutoSortInsertion;
+
+  quickSort3Way(first, last, lessThan);
+  return AutoSortQuick3Way;
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+
+
+/// resumable Quick Sort (random-access iterators only): sorts in small steps with bounded work,
+/// e.g. to interleave sorting with other tasks in an event loop or a coroutine
+/// usage: ResumableSort<iterator> sorter(first, last); while (!sorter.step(10000)) doSomethingElse();
+template <typename iterator, typename LessThan = std::less<typename std::iterator_traits<iterator>::value_type> >
+class ResumableSort
+{
+public:
+  /// prepare sorting, nothing is sorted yet
+  ResumableSort(iterator first, iterator last, LessThan lessThan = LessThan())
+  : lessThan(lessThan), stackSize(0), partitioning(false)
+  {
+    push(first, last);
+  }
+
+  /// sort with at most about "budget" comparisons, return true if finished
+  bool step(size_t budget)
+  {
+    while (budget > 0)
+    {
+      if (partitioning)
+      {
+        partitionStep(budget);
+        continue;
+      }
+
+      // all done ?
+      if (stackSize == 0)
+        return true;
+
+      // next range
+      --stackSize;
+      auto first = stack[stackSize].first;
+      auto last  = stack[stackSize].last;
+      size_t numElements = last - first;
+
+      // small ranges are processed at once
+      if (numElements <= SmallRange)
+      {
+        insertionSort(first, last, lessThan);
+        size_t work = numElements * numElements / 4;
+        budget = budget > work ? budget - work : 0;
+        continue;
+      }
+
+      // median-of-3 becomes the first element
+      auto middle = first + numElements / 2;
+      std::iter_swap(first, sortMedianOf3(first + 1, middle, last - 1, lessThan));
+      budget = budget > 3 ? budget - 3 : 0;
+
+      base  = first;
+      left  = 0;
+      right = numElements;
+      high  = numElements - 1;
+      scanLeft     = true;
+      partitioning = true;
+    }
+
+    return stackSize == 0 && !partitioning;
+  }
+
+  /// true if sorting is finished
+  bool done() const
+  {
+    return stackSize == 0 && !partitioning;
+  }
+
+private:
+  /// ranges up to this size are handled by Insertion Sort
+  static const size_t SmallRange = 16;
+
+  /// store range for later processing
+  void push(iterator first, iterator last)
+  {
+    if (last - first > 1)
+    {
+      stack[stackSize].first = first;
+      stack[stackSize].last  = last;
+      stackSize++;
+    }
+  }
+
+  /// continue partitioning the current range around its first element, decrement budget for each comparison
+  void partitionStep(size_t& budget)
+  {
+    auto& pivot = *base;
+    while (budget > 0)
+    {
+      if (scanLeft)
+      {
+        // find element not smaller than pivot, scanning from the left
+        budget--;
+        if (lessThan(*(base + ++left), pivot) && left != high)
+          continue;
+        scanLeft = false;
+        if (budget == 0)
+          break;
+      }
+
+      // find element not larger than pivot, scanning from the right
+      budget--;
+      if (lessThan(pivot, *(base + --right)) && right != 0)
+        continue;
+
+      // pointers crossed ? => partitioning finished
+      if (left >= right)
+      {
+        std::iter_swap(base, base + right);
+        partitioning = false;
+
+        // postpone larger partition, smaller partition will be processed next
+        auto pivotPos = base + right;
+        auto last     = base + high + 1;
+        if (right > high - right)
+        {
+          push(base, pivotPos);
+          push(pivotPos + 1, last);
+        }
+        else
+        {
+          push(pivotPos + 1, last);
+          push(base, pivotPos);
+        }
+        return;
+      }
+
+      std::iter_swap(base + left, base + right);
+      scanLeft = true;
+    }
+  }
+
+  /// user-defined less-than operator
+  LessThan lessThan;
+
+  /// range of pending partitions
+  struct Range
+  {
+    iterator first;
+    iterator last;
+  };
+  /// pending partitions, smaller partitions are always on top => at most log2(n) + 1 entries
+  Range  stack[8 * sizeof(size_t) + 1];
+  size_t stackSize;
+
+  /// true if a partitioning step is in progress
+  bool      partitioning;
+  /// current partition: first element (which is the pivot)
+  iterator  base;
+  /// current partition: scanning positions and last element, relative to "base"
+  size_t    left, right, high;
+  /// current partition: scanning from the left (true) or from the right (false)
+  bool      scanLeft;
+};
+
+
+// /////////////////////////////////////////////////////////////////////
+// verified sorting: cheap enough for production, O(n) and parallel
+
+
+/// ranges with at least this many elements are checked by multiple threads
+const size_t VerifyParallelMinSize = 1 << 18;
+
+
+/// number of threads to check "numElements" elements (each thread gets at least VerifyParallelMinSize / 4 elements)
+inline size_t verifyNumThreads(size_t numElements)
+{
+  if (numElements < VerifyParallelMinSize)
+    return 1;
+  size_t numThreads = std::thread::hardware_concurrency();
+  numThreads = std::min(numThreads, numElements / (VerifyParallelMinSize / 4));
+  return numThreads > 1 ? numThreads : 1;
+}
+
+
+/// true if all elements are in ascending order: stops at the first problem
+template <typename iterator, typename LessThan>
+bool isSortedSequential(iterator first, iterator last, LessThan lessThan, std::false_type)
+{
+  if (first == last)
+    return true;
+  for (auto next = std::next(first); next != last; first = next, ++next)
+    if (lessThan(*next, *first))
+      return false;
+  return true;
+}
+
+
+/// true if all elements are in ascending order: count neighbors which are out of order without branches so that the compiler can vectorize it
+template <typename iterator, typename LessThan>
+bool isSortedSequential(iterator first, iterator last, LessThan lessThan, std::true_type)
+{
+  const size_t BlockSize = 1024;
+
+  size_t numElements = last - first;
+  if (numElements <= 1)
+    return true;
+
+  auto data = &*first;
+  for (size_t block = 1; block < numElements; block += BlockSize)
+  {
+    size_t blockEnd   = std::min(block + BlockSize, numElements);
+    size_t violations = 0;
+    for (size_t i = block; i < blockEnd; i++)
+      violations += lessThan(data[i], data[i - 1]) ? 1 : 0;
+    if (violations > 0)
+      return false;
+  }
+  return true;
+}
+
+
+/// true if all elements are in ascending order, random-access iterators are checked by multiple threads
+template <typename iterator, typename LessThan>
+bool isSorted(iterator first, iterator last, LessThan lessThan, std::random_access_iterator_tag)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  typedef std::integral_constant<bool, IsContiguousIterator<iterator>::value &&
+                                       IsCheapComparison<Value, LessThan>::value> Vectorize;
+
+  size_t numElements = last - first;
+  size_t numThreads  = verifyNumThreads(numElements);
+  if (numThreads == 1)
+    return isSortedSequential(first, last, lessThan, Vectorize());
+
+  // each thread checks a chunk plus the first element of the next chunk
+  std::vector<char>        sorted(numThreads, 1);
+  std::vector<std::thread> threads;
+  size_t chunkSize = (numElements + numThreads - 1) / numThreads;
+  for (size_t thread = 0; thread < numThreads; thread++)
+  {
+    size_t from = thread * chunkSize;
+    size_t to   = std::min(from + chunkSize + 1, numElements);
+    threads.push_back(std::thread([=, &sorted]()
+                      { sorted[thread] = isSortedSequential(first + from, first + to, lessThan, Vectorize()); }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  return std::find(sorted.begin(), sorted.end(), 0) == sorted.end();
+}
+
+
+/// true if all elements are in ascending order (forward and bidirectional iterators)
+template <typename iterator, typename LessThan>
+bool isSorted(iterator first, iterator last, LessThan lessThan, std::forward_iterator_tag)
+{
+  return isSortedSequential(first, last, lessThan, std::false_type());
+}
+
+
+/// true if all elements are in ascending order, allow user-defined less-than operator
+template <typename iterator, typename LessThan>
+bool isSorted(iterator first, iterator last, LessThan lessThan)
+{
+  return isSorted(first, last, lessThan, typename std::iterator_traits<iterator>::iterator_category());
+}
+
+
+/// true if all elements are in ascending order
+template <typename iterator>
+bool isSorted(iterator first, iterator last)
+{
+  return isSorted(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// spread the bits of a hash (MurmurHash3's finalizer), identity hashes such as std::hash<int> become useful for sums
+inline uint64_t mixHash(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+
+/// sum of the hashes of all elements in [first,last)
+template <typename iterator, typename Hash>
+uint64_t fingerprintSequential(iterator first, iterator last, Hash hash)
+{
+  uint64_t sum = 0;
+  for (; first != last; ++first)
+    sum += mixHash(hash(*first));
+  return sum;
+}
+
+
+/// order-independent fingerprint of a multiset: doesn't change while sorting but when elements are lost or duplicated
+template <typename iterator, typename Hash>
+uint64_t fingerprint(iterator first, iterator last, Hash hash, std::random_access_iterator_tag)
+{
+  size_t numElements = last - first;
+  size_t numThreads  = verifyNumThreads(numElements);
+  if (numThreads == 1)
+    return fingerprintSequential(first, last, hash);
+
+  std::vector<uint64_t>    sums(numThreads, 0);
+  std::vector<std::thread> threads;
+  size_t chunkSize = (numElements + numThreads - 1) / numThreads;
+  for (size_t thread = 0; thread < numThreads; thread++)
+  {
+    size_t from = std::min(thread * chunkSize, numElements);
+    size_t to   = std::min(from + chunkSize,   numElements);
+    threads.push_back(std::thread([=, &sums]() { sums[thread] = fingerprintSequential(first + from, first + to, hash); }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  uint64_t sum = 0;
+  for (auto x : sums)
+    sum += x;
+  return sum;
+}
+
+
+/// order-independent fingerprint of a multiset (forward and bidirectional iterators)
+template <typename iterator, typename Hash>
+uint64_t fingerprint(iterator first, iterator last, Hash hash, std::forward_iterator_tag)
+{
+  return fingerprintSequential(first, last, hash);
+}
+
+
+/// order-independent fingerprint of a multiset, allow user-defined hash function
+template <typename iterator, typename Hash>
+uint64_t fingerprint(iterator first, iterator last, Hash hash)
+{
+  return fingerprint(first, last, hash, typename std::iterator_traits<iterator>::iterator_category());
+}
+
+
+/// order-independent fingerprint of a multiset, based on std::hash
+template <typename iterator>
+uint64_t fingerprint(iterator first, iterator last)
+{
+  return fingerprint(first, last, std::hash<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// run any sort algorithm, then verify in O(n) that the output is sorted and contains the same elements as the input,
+/// return false if the sort algorithm failed, i.e.:
+/// verifiedSort(data.begin(), data.end(), myless(), [](Iterator first, Iterator last, myless lessThan) { introSort(first, last, lessThan); }, myhash());
+template <typename iterator, typename LessThan, typename Sorter, typename Hash>
+bool verifiedSort(iterator first, iterator last, LessThan lessThan, Sorter sorter, Hash hash)
+{
+  auto before = fingerprint(first, last, hash);
+  sorter(first, last, lessThan);
+  return isSorted(first, last, lessThan) && fingerprint(first, last, hash) == before;
+}
+
+
+/// verify any sort algorithm with default less-than operator and std::hash, i.e.:
+/// verifiedSort(data.begin(), data.end(), [](Iterator first, Iterator last, std::less<int>) { introSort(first, last); });
+template <typename iterator, typename Sorter>
+bool verifiedSort(iterator first, iterator last, Sorter sorter)
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  return verifiedSort(first, last, std::less<Value>(), sorter, std::hash<Value>());
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+// algorithm properties, e.g. to choose an algorithm in generic code at compile time
+
+
+/// function objects calling the sort algorithms, i.e. MergeSorter()(container.begin(), container.end(), std::less<int>());
+struct BubbleSorter              { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { bubbleSort             (first, last, lessThan); } };
+struct SelectionSorter           { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { selectionSort          (first, last, lessThan); } };
+struct InsertionSorter           { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { insertionSort          (first, last, lessThan); } };
+struct BinaryInsertionSorter     { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { binaryInsertionSort    (first, last, lessThan); } };
+struct ShellSorter               { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { shellSort              (first, last, lessThan); } };
+struct HeapSorter                { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { heapSort               (first, last, lessThan); } };
+struct MergeSorter               { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { mergeSort              (first, last, lessThan); } };
+struct MergeSorterInPlace        { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { mergeSortInPlace       (first, last, lessThan); } };
+struct MergeSorterBottomUp       { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { mergeSortBottomUp      (first, last, lessThan); } };
+struct MergeSorterTiled          { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { mergeSortTiled         (first, last, lessThan); } };
+struct MergeInsertionSorter      { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { mergeInsertionSort     (first, last, lessThan); } };
+struct MergeSorterMinComparisons { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { mergeSortMinComparisons(first, last, lessThan); } };
+struct QuickSorter               { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { quickSort              (first, last, lessThan); } };
+struct QuickSorterIterative      { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { quickSortIterative     (first, last, lessThan); } };
+struct QuickSorter3Way           { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { quickSort3Way          (first, last, lessThan); } };
+struct IntroSorter               { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { introSort              (first, last, lessThan); } };
+struct SmallSorter               { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { smallSort              (first, last, lessThan); } };
+struct AutoSorter                { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan lessThan) const { autoSort               (first, last, lessThan); } };
+/// Radix Sort ignores the less-than operator (must be std::less)
+struct RadixSorter               { template <typename iterator, typename LessThan> void operator()(iterator first, iterator last, LessThan)          const { radixSort              (first, last); } };
+
+
+/// stable:      equal elements keep their original order
+/// inPlace:     no heap memory proportional to the number of elements
+/// MinIterator: weakest supported iterator category
+template <bool Stable, bool InPlace, typename MinIteratorTag>
+struct SortProperties
+{
+  static const bool stable  = Stable;
+  static const bool inPlace = InPlace;
+  typedef MinIteratorTag MinIterator;
+};
+
+/// properties of each sort algorithm (undefined for unknown algorithms)
+template <typename Algorithm>
+struct SortTraits;
+
+template <> struct SortTraits<BubbleSorter>              : SortProperties<true,  true,  std::bidirectional_iterator_tag> {};
+template <> struct SortTraits<SelectionSorter>           : SortProperties<false, true,  std::forward_iterator_tag>       {};
+template <> struct SortTraits<InsertionSorter>           : SortProperties<true,  true,  std::bidirectional_iterator_tag> {};
+template <> struct SortTraits<BinaryInsertionSorter>     : SortProperties<true,  true,  std::bidirectional_iterator_tag> {};
+template <> struct SortTraits<ShellSorter>               : SortProperties<false, true,  std::bidirectional_iterator_tag> {};
+template <> struct SortTraits<HeapSorter>                : SortProperties<false, true,  std::random_access_iterator_tag> {};
+template <> struct SortTraits<MergeSorter>               : SortProperties<true,  false, std::forward_iterator_tag>       {};
+// in-place merging moves elements of the left half past equal elements of the right half
+template <> struct SortTraits<MergeSorterInPlace>        : SortProperties<false, true,  std::forward_iterator_tag>       {};
+template <> struct SortTraits<MergeSorterBottomUp>       : SortProperties<true,  false, std::forward_iterator_tag>       {};
+template <> struct SortTraits<MergeSorterTiled>          : SortProperties<true,  false, std::random_access_iterator_tag> {};
+template <> struct SortTraits<MergeInsertionSorter>      : SortProperties<false, false, std::random_access_iterator_tag> {};
+template <> struct SortTraits<MergeSorterMinComparisons> : SortProperties<false, false, std::random_access_iterator_tag> {};
+template <> struct SortTraits<QuickSorter>               : SortProperties<false, true,  std::forward_iterator_tag>       {};
+template <> struct SortTraits<QuickSorterIterative>      : SortProperties<false, true,  std::forward_iterator_tag>       {};
+template <> struct SortTraits<QuickSorter3Way>           : SortProperties<false, true,  std::random_access_iterator_tag> {};
+template <> struct SortTraits<IntroSorter>               : SortProperties<false, true,  std::bidirectional_iterator_tag> {};
+template <> struct SortTraits<SmallSorter>               : SortProperties<false, true,  std::forward_iterator_tag>       {};
+template <> struct SortTraits<AutoSorter>                : SortProperties<false, false, std::random_access_iterator_tag> {};
+template <> struct SortTraits<RadixSorter>               : SortProperties<true,  false, std::random_access_iterator_tag> {};
+
+
+/// true if an algorithm can sort a range of "iterator"
+template <typename Algorithm, typename iterator>
+struct SortSupports : std::is_base_of<typename SortTraits<Algorithm>::MinIterator,
+                                      typename std::iterator_traits<iterator>::iterator_category> {};
+
+
+/// fastest stable algorithm: LSD Radix Sort for integers (std::less), bottom-up Merge Sort for other random-access iterators,
+/// Merge Sort for linked lists
+template <typename iterator, typename LessThan>
+struct StableSorter
+{
+  typedef typename std::iterator_traits<iterator>::value_type Value;
+  typedef typename std::conditional<IsRadixSortable<Value, LessThan>::value, RadixSorter, MergeSorterBottomUp>::type RandomAccess;
+  typedef typename std::conditional<std::is_base_of<std::random_access_iterator_tag,
+                                                    typename std::iterator_traits<iterator>::iterator_category>::value,
+                                    RandomAccess, MergeSorter>::type type;
+
+  static_assert(SortTraits<type>::stable, "stableSort must choose a stable algorithm");
+};
+
+
+/// stable sort, chooses the fastest stable algorithm at compile time, allow user-defined less-than operator (requires additional memory)
+template <typename iterator, typename LessThan>
+void stableSort(iterator first, iterator last, LessThan lessThan)
+{
+  typename StableSorter<iterator, LessThan>::type sorter;
+  sorter(first, last, lessThan);
+}
+
+
+/// stable sort with default less-than operator (requires additional memory)
+template <typename iterator>
+void stableSort(iterator first, iterator last)
+{
+  stableSort(first, last, std::less<typename std::iterator_traits<iterator>::value_type>());
+}
+
+
+/// stable sort without any heap allocations: Merge Sort with in-place (rotation-based) merging
+template <typename iterator, typename LessThan>
+void stableSort(iterator first, iterator last, LessThan lessThan, NoAlloc)
+{
+  mergeSort(first, last, lessThan, NoAlloc());
 }
@@ -0,0 +1,23 @@
+// //////////////////////////////////////////////////////////
+// sort_tuning.h
+// generated by calibrate.cpp, default values
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+// re-generate on the target machine:
+// g++ -O3 -std=c++11 calibrate.cpp -o calibrate && ./calibrate sort_tuning.h
+
+#pragma once
+
+#include <cstddef> // size_t
+
+/// Intro Sort switches to Insertion Sort for ranges up to this size
+constexpr size_t SortTuningIntroSortCutoff = 16;
+/// width of n-ary Heap Sort in the benchmark
+constexpr size_t SortTuningNaryHeapWidth   = 8;
+/// benchmark skips O(n^2) algorithms beyond this number of elements
+constexpr int    SortTuningRestrictedSort  = 25000;
+/// Auto Sort prefers Radix Sort for integers when there are at least this many elements
+constexpr size_t SortTuningMinRadixSize    = 2048;
+/// tiled Merge Sort sorts tiles of this size (in bytes) in the cache before merging them
+constexpr size_t SortTuningTileBytes       = 262144;
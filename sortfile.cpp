@@ -0,0 +1,437 @@
+// //////////////////////////////////////////////////////////
+// sortfile.cpp
+// Copyright (c) 2020 Stephan Brumme. All rights reserved.
+// see http://create.stephan-brumme.com/disclaimer.html
+//
+
+// g++ -O3 -std=c++11 sortfile.cpp -o sortfile
+// Linux/POSIX only (mmap)
+//
+// ./sortfile gen      <file> <numRecords> [seed]                        => GenSort-style 100 byte records (10 byte key)
+// ./sortfile sort     <file> <recordSize> [keyOffset] [keyWidth]        => sort in-place via mmap
+// ./sortfile readsort <file> <recordSize> [keyOffset] [keyWidth]        => same result via read/sort/write (for comparison)
+// ./sortfile validate <file> <recordSize> [keyOffset] [keyWidth]        => check order, show checksum
+//
+// supported record sizes: 4, 8, 16, 32, 64, 100, 128, 256 bytes
+// keys are compared as unsigned bytes (memcmp), default key is the whole record (but 10 bytes for 100 byte records)
+// the checksum is independent of the records' order: it must not change when sorting
+
+#include <cstdio>
+#include <cerrno>    // errno
+#include <cstdlib>   // strtoull
+#include <cstring>   // memcmp, strcmp
+
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "sort.h"
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0
+#endif
+
+
+// timing
+static double seconds()
+{
+  timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec/1000000.0;
+}
+
+
+/// fixed-width record, trivially copyable
+template <size_t RecordSize>
+struct Record
+{
+  unsigned char bytes[RecordSize];
+};
+
+/// compare records by their keys (unsigned bytes, lexicographically)
+template <size_t RecordSize>
+struct RecordLess
+{
+  RecordLess(size_t keyOffset, size_t keyWidth)
+  : keyOffset(keyOffset), keyWidth(keyWidth)
+  {}
+
+  bool operator()(const Record<RecordSize>& a, const Record<RecordSize>& b) const
+  {
+    return memcmp(a.bytes + keyOffset, b.bytes + keyOffset, keyWidth) < 0;
+  }
+
+  size_t keyOffset;
+  size_t keyWidth;
+};
+
+
+/// 64 bit FNV-1a hash of a single record
+static unsigned long long hashRecord(const unsigned char* record, size_t recordSize)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < recordSize; i++)
+    hash = (hash ^ record[i]) * 1099511628211ULL;
+  return hash;
+}
+
+/// sum of all records' hashes, doesn't depend on the records' order
+static unsigned long long checksum(const unsigned char* data, size_t numRecords, size_t recordSize)
+{
+  unsigned long long sum = 0;
+  for (size_t i = 0; i < numRecords; i++)
+    sum += hashRecord(data + i * recordSize, recordSize);
+  return sum;
+}
+
+
+/// map a whole file, return NULL on failure
+static unsigned char* mapFile(const char* filename, bool writable, size_t& fileSize, int& handle)
+{
+  handle = open(filename, writable ? O_RDWR : O_RDONLY);
+  if (handle < 0)
+  {
+    printf("cannot open %s\n", filename);
+    return NULL;
+  }
+
+  struct stat info;
+  if (fstat(handle, &info) != 0 || info.st_size == 0)
+  {
+    printf("cannot map empty file %s\n", filename);
+    close(handle);
+    return NULL;
+  }
+  fileSize = info.st_size;
+
+  // read whole file at once
+  void* data = mmap(NULL, fileSize, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                    MAP_SHARED | MAP_POPULATE, handle, 0);
+  if (data == MAP_FAILED)
+  {
+    printf("cannot map %s\n", filename);
+    close(handle);
+    return NULL;
+  }
+
+  // sorting jumps all over the file, no read-ahead beyond MAP_POPULATE needed
+  madvise(data, fileSize, writable ? MADV_RANDOM : MADV_SEQUENTIAL);
+  madvise(data, fileSize, MADV_WILLNEED);
+  return (unsigned char*)data;
+}
+
+/// unmap file, flush changes if "writable"
+static bool unmapFile(unsigned char* data, size_t fileSize, bool writable, int handle)
+{
+  bool ok = true;
+  if (writable && msync(data, fileSize, MS_SYNC) != 0)
+  {
+    printf("msync failed\n");
+    ok = false;
+  }
+  munmap(data, fileSize);
+  close(handle);
+  return ok;
+}
+
+
+/// sort records in-place, Auto Sort handles presorted files and many duplicate keys gracefully
+template <size_t RecordSize>
+AutoSortChoice sortRecords(unsigned char* data, size_t numRecords, size_t keyOffset, size_t keyWidth)
+{
+  auto first = (Record<RecordSize>*)data;
+  return autoSort(first, first + numRecords, RecordLess<RecordSize>(keyOffset, keyWidth));
+}
+
+/// true if records are sorted
+template <size_t RecordSize>
+bool isSortedRecords(const unsigned char* data, size_t numRecords, size_t keyOffset, size_t keyWidth)
+{
+  auto first = (const Record<RecordSize>*)data;
+  return std::is_sorted(first, first + numRecords, RecordLess<RecordSize>(keyOffset, keyWidth));
+}
+
+
+/// true if a template instance exists for that record size
+static bool isSupported(size_t recordSize)
+{
+  const size_t Supported[] = { 4, 8, 16, 32, 64, 100, 128, 256 };
+  for (auto size : Supported)
+    if (size == recordSize)
+      return true;
+  return false;
+}
+
+/// map runtime record size to a template instance, return false if not supported
+static bool dispatchSort(size_t recordSize, unsigned char* data, size_t numRecords, size_t keyOffset, size_t keyWidth,
+                         AutoSortChoice& choice)
+{
+  switch (recordSize)
+  {
+  case   4: choice = sortRecords<  4>(data, numRecords, keyOffset, keyWidth); return true;
+  case   8: choice = sortRecords<  8>(data, numRecords, keyOffset, keyWidth); return true;
+  case  16: choice = sortRecords< 16>(data, numRecords, keyOffset, keyWidth); return true;
+  case  32: choice = sortRecords< 32>(data, numRecords, keyOffset, keyWidth); return true;
+  case  64: choice = sortRecords< 64>(data, numRecords, keyOffset, keyWidth); return true;
+  case 100: choice = sortRecords<100>(data, numRecords, keyOffset, keyWidth); return true;
+  case 128: choice = sortRecords<128>(data, numRecords, keyOffset, keyWidth); return true;
+  case 256: choice = sortRecords<256>(data, numRecords, keyOffset, keyWidth); return true;
+  default:  return false;
+  }
+}
+
+/// map runtime record size to a template instance, "supported" becomes false if not supported
+static bool dispatchIsSorted(size_t recordSize, const unsigned char* data, size_t numRecords, size_t keyOffset, size_t keyWidth,
+                             bool& supported)
+{
+  supported = true;
+  switch (recordSize)
+  {
+  case   4: return isSortedRecords<  4>(data, numRecords, keyOffset, keyWidth);
+  case   8: return isSortedRecords<  8>(data, numRecords, keyOffset, keyWidth);
+  case  16: return isSortedRecords< 16>(data, numRecords, keyOffset, keyWidth);
+  case  32: return isSortedRecords< 32>(data, numRecords, keyOffset, keyWidth);
+  case  64: return isSortedRecords< 64>(data, numRecords, keyOffset, keyWidth);
+  case 100: return isSortedRecords<100>(data, numRecords, keyOffset, keyWidth);
+  case 128: return isSortedRecords<128>(data, numRecords, keyOffset, keyWidth);
+  case 256: return isSortedRecords<256>(data, numRecords, keyOffset, keyWidth);
+  default:  supported = false; return false;
+  }
+}
+
+
+/// GenSort-style records: 10 byte binary key, 2 bytes 0x00 0x11, 32 hex digits record number,
+/// 4 bytes 0x88 0x99 0xAA 0xBB, 48 bytes filler, 4 bytes 0xCC 0xDD 0xEE 0xFF
+static int generate(const char* filename, size_t numRecords, unsigned long long seed)
+{
+  const size_t RecordSize = 100;
+  FILE* output = fopen(filename, "wb");
+  if (!output)
+  {
+    printf("cannot write %s\n", filename);
+    return 1;
+  }
+
+  // xorshift64*
+  unsigned long long state = seed ? seed : 1;
+  const char* hex = "0123456789ABCDEF";
+
+  std::vector<unsigned char> record(RecordSize);
+  unsigned long long sum = 0;
+  for (size_t i = 0; i < numRecords; i++)
+  {
+    // random key
+    for (size_t pos = 0; pos < 10; pos++)
+    {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      record[pos] = (unsigned char)((state * 2685821657736338717ULL) >> 56);
+    }
+    record[10] = 0x00;
+    record[11] = 0x11;
+
+    // record number as 32 hex digits
+    for (size_t pos = 0; pos < 32; pos++)
+    {
+      int shift = 4 * (31 - int(pos));
+      record[12 + pos] = shift < 64 ? hex[(i >> shift) & 15] : '0';
+    }
+
+    record[44] = 0x88; record[45] = 0x99; record[46] = 0xAA; record[47] = 0xBB;
+    // filler depends on record number
+    for (size_t pos = 48; pos < 96; pos++)
+      record[pos] = hex[(i + pos) & 15];
+    record[96] = 0xCC; record[97] = 0xDD; record[98] = 0xEE; record[99] = 0xFF;
+
+    sum += hashRecord(record.data(), RecordSize);
+    if (fwrite(record.data(), RecordSize, 1, output) != 1)
+    {
+      printf("cannot write %s\n", filename);
+      fclose(output);
+      return 1;
+    }
+  }
+
+  fclose(output);
+  printf("generated %llu records, checksum %016llx\n", (unsigned long long)numRecords, sum);
+  return 0;
+}
+
+
+/// sort a file in-place via mmap or via read/sort/write
+static int sortFile(const char* filename, size_t recordSize, size_t keyOffset, size_t keyWidth, bool useMap)
+{
+  double start = seconds();
+
+  size_t fileSize = 0;
+  int handle = -1;
+  unsigned char* data = NULL;
+  std::vector<unsigned char> buffer;
+  FILE* file = NULL;
+  if (useMap)
+  {
+    data = mapFile(filename, true, fileSize, handle);
+    if (!data)
+      return 1;
+  }
+  else
+  {
+    file = fopen(filename, "r+b");
+    if (!file)
+    {
+      printf("cannot open %s\n", filename);
+      return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    buffer.resize(fileSize);
+    if (fileSize == 0 || fread(buffer.data(), fileSize, 1, file) != 1)
+    {
+      printf("cannot read %s\n", filename);
+      fclose(file);
+      return 1;
+    }
+    data = buffer.data();
+  }
+
+  if (fileSize % recordSize != 0)
+    printf("warning: %llu trailing bytes are ignored\n", (unsigned long long)(fileSize % recordSize));
+  size_t numRecords = fileSize / recordSize;
+  double loaded = seconds();
+
+  AutoSortChoice choice = AutoSortQuickIterative;
+  bool ok = dispatchSort(recordSize, data, numRecords, keyOffset, keyWidth, choice);
+  if (!ok)
+    printf("record size %d not supported\n", int(recordSize));
+  double sorted = seconds();
+
+  // write back
+  if (useMap)
+    ok &= unmapFile(data, fileSize, true, handle);
+  else
+  {
+    if (ok)
+    {
+      fseek(file, 0, SEEK_SET);
+      ok = fwrite(buffer.data(), fileSize, 1, file) == 1 && fflush(file) == 0 && fsync(fileno(file)) == 0;
+      if (!ok)
+        printf("cannot write %s\n", filename);
+    }
+    fclose(file);
+  }
+  double finished = seconds();
+
+  printf("%s %llu records: load %.3f s, sort %.3f s (%s), write %.3f s, total %.3f s\n",
+         useMap ? "mmap" : "read/write", (unsigned long long)numRecords,
+         loaded - start, sorted - loaded, autoSortName(choice), finished - sorted, finished - start);
+  return ok ? 0 : 1;
+}
+
+
+/// check whether a file is sorted, show checksum
+static int validate(const char* filename, size_t recordSize, size_t keyOffset, size_t keyWidth)
+{
+  size_t fileSize = 0;
+  int handle = -1;
+  unsigned char* data = mapFile(filename, false, fileSize, handle);
+  if (!data)
+    return 1;
+
+  size_t numRecords = fileSize / recordSize;
+  bool supported;
+  bool sorted = dispatchIsSorted(recordSize, data, numRecords, keyOffset, keyWidth, supported);
+  unsigned long long sum = checksum(data, numRecords, recordSize);
+  unmapFile(data, fileSize, false, handle);
+
+  if (!supported)
+  {
+    printf("record size %d not supported\n", int(recordSize));
+    return 1;
+  }
+  printf("%llu records, %s, checksum %016llx\n", (unsigned long long)numRecords, sorted ? "sorted" : "NOT SORTED", sum);
+  return sorted ? 0 : 2;
+}
+
+
+/// parse a non-negative decimal number, false if "text" contains anything else or the number is too large
+static bool parseNumber(const char* text, size_t& number)
+{
+  // strtoull silently negates "-1"
+  if (*text < '0' || *text > '9')
+    return false;
+
+  char* end = NULL;
+  errno = 0;
+  unsigned long long value = strtoull(text, &end, 10);
+  if (errno != 0 || *end != 0 || value != (unsigned long long)size_t(value))
+    return false;
+
+  number = size_t(value);
+  return true;
+}
+
+
+int main(int argc, char** argv)
+{
+  if (argc < 4)
+  {
+    printf("usage: %s gen      <file> <numRecords> [seed]\n"
+           "       %s sort     <file> <recordSize> [keyOffset] [keyWidth]\n"
+           "       %s readsort <file> <recordSize> [keyOffset] [keyWidth]\n"
+           "       %s validate <file> <recordSize> [keyOffset] [keyWidth]\n",
+           argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+  }
+
+  const char* command  = argv[1];
+  const char* filename = argv[2];
+  if (strcmp(command, "gen") == 0)
+  {
+    size_t numRecords = 0;
+    size_t seed       = 1;
+    if (!parseNumber(argv[3], numRecords) || (argc >= 5 && !parseNumber(argv[4], seed)))
+    {
+      printf("invalid number of records / seed\n");
+      return 1;
+    }
+    return generate(filename, numRecords, seed);
+  }
+
+  size_t recordSize = 0;
+  size_t keyOffset  = 0;
+  if (!parseNumber(argv[3], recordSize) || recordSize == 0 ||
+      (argc >= 5 && !parseNumber(argv[4], keyOffset)) || keyOffset >= recordSize)
+  {
+    printf("invalid record size / key\n");
+    return 1;
+  }
+
+  // key defaults to the rest of the record, except for GenSort's 100 byte records
+  size_t keyWidth = recordSize == 100 && keyOffset == 0 ? 10 : recordSize - keyOffset;
+  if ((argc >= 6 && !parseNumber(argv[5], keyWidth)) || keyWidth == 0 || keyWidth > recordSize - keyOffset)
+  {
+    printf("invalid record size / key\n");
+    return 1;
+  }
+  if (!isSupported(recordSize))
+  {
+    printf("record size %d not supported\n", int(recordSize));
+    return 1;
+  }
+
+  if (strcmp(command, "sort") == 0)
+    return sortFile(filename, recordSize, keyOffset, keyWidth, true);
+  if (strcmp(command, "readsort") == 0)
+    return sortFile(filename, recordSize, keyOffset, keyWidth, false);
+  if (strcmp(command, "validate") == 0)
+    return validate(filename, recordSize, keyOffset, keyWidth);
+
+  printf("unknown command %s\n", command);
+  return 1;
+}